@@ -0,0 +1,279 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "clustergraph.h"
+#include "maze.h"
+
+#include <QDebug>
+#include <QTest>
+#include <QVector>
+
+/**
+ * @brief Checks that opening or closing a Cell during the game gives the same Maze as preparing it again.
+ */
+class MazeTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+
+    /**
+     * Opens or closes each Cell in turn, then restores it, and compares the repaired Maze with a prepared one.
+     */
+    void testChangeCell();
+
+    /**
+     * Opens or closes each Cell of a Maze spanning several clusters, updates a ClusterGraph of it,
+     * and compares its paths with the ones of a ClusterGraph built again.
+     */
+    void testUpdateClusterGraph();
+
+private:
+
+    /**
+     * Builds the test Maze : a horizontal and a vertical tunnel, a border Cell that makes a tunnel once the
+     * opposite one is opened, and a portal.
+     * @param p_maze the Maze to build
+     * @param p_nbTiles the number of times the test Maze is repeated across and down, each copy having its own portal
+     */
+    void initMaze(Maze &p_maze, const int p_nbTiles = 1) const;
+
+    /**
+     * Prepares a Maze with the Cell types of another one, and compares the derived data of both.
+     * @param p_maze the repaired Maze
+     */
+    void compareWithPrepared(const Maze &p_maze) const;
+
+    /**
+     * Builds a ClusterGraph of a Maze again, and compares the lengths of its paths with the ones of an updated ClusterGraph.
+     * @param p_maze the Maze
+     * @param p_clusterGraph the updated ClusterGraph
+     */
+    void compareWithBuilt(const Maze &p_maze, const ClusterGraph &p_clusterGraph) const;
+};
+
+namespace
+{
+/** The test Maze : '#' for a wall, '.' for a corridor, 'x' for the Ghost camp */
+const char *const ROWS[] = {
+    "#####.#####",
+    "#...#.#...#",
+    "#.#.....#.#",
+    "..#.#x#.#..",
+    "#...#x#...#",
+    "#.#.....#.#",
+    "#.###.###.#",
+    "#....#....#",
+    "#####.###.#"
+};
+const int NB_ROWS = 9;
+const int NB_COLUMNS = 11;
+
+/** The resurrection Cell, which is never changed */
+const int RESURRECTION_ROW = 4;
+const int RESURRECTION_COLUMN = 5;
+
+const Maze::Direction DIRECTIONS[4] = {Maze::UP, Maze::RIGHT, Maze::DOWN, Maze::LEFT};
+
+/** The number of times the test Maze is repeated across and down, so that it spans several clusters of a ClusterGraph */
+const int NB_CLUSTER_TILES = 2;
+
+/** The paths of the ClusterGraph are compared between every open Cell and one open Cell in this number */
+const int CLUSTER_TARGET_PERIOD = 16;
+}
+
+void MazeTest::initMaze(Maze &p_maze, const int p_nbTiles) const
+{
+    p_maze.init(NB_ROWS * p_nbTiles, NB_COLUMNS * p_nbTiles);
+    for (int i = 0; i < NB_ROWS * p_nbTiles; ++i) {
+        for (int j = 0; j < NB_COLUMNS * p_nbTiles; ++j) {
+            if (ROWS[i % NB_ROWS][j % NB_COLUMNS] == '.') {
+                p_maze.setCellType(i, j, Cell::CORRIDOR);
+            } else if (ROWS[i % NB_ROWS][j % NB_COLUMNS] == 'x') {
+                p_maze.setCellType(i, j, Cell::GHOSTCAMP);
+            }
+        }
+    }
+    for (int i = 0; i < p_nbTiles; ++i) {
+        for (int j = 0; j < p_nbTiles; ++j) {
+            p_maze.addPortal(i * NB_ROWS + 7, j * NB_COLUMNS + 1, i * NB_ROWS + 1, j * NB_COLUMNS + 9);
+        }
+    }
+    p_maze.setResurrectionCell(QPoint(RESURRECTION_ROW, RESURRECTION_COLUMN));
+}
+
+void MazeTest::compareWithPrepared(const Maze &p_maze) const
+{
+    Maze prepared;
+    initMaze(prepared);
+    for (int i = 0; i < NB_ROWS; ++i) {
+        for (int j = 0; j < NB_COLUMNS; ++j) {
+            prepared.setCellType(i, j, p_maze.getCellType(i, j));
+        }
+    }
+    prepared.prepare();
+
+    for (int i = 0; i < NB_ROWS; ++i) {
+        for (int j = 0; j < NB_COLUMNS; ++j) {
+            const int index = p_maze.getCellIndex(i, j);
+            QCOMPARE(p_maze.getPortalExit(i, j), prepared.getPortalExit(i, j));
+            QCOMPARE(p_maze.getPortalDirection(i, j), prepared.getPortalDirection(i, j));
+            for (int k = 0; k < 4; ++k) {
+                QCOMPARE(p_maze.getNeighbourIndex(index, DIRECTIONS[k]), prepared.getNeighbourIndex(index, DIRECTIONS[k]));
+            }
+            QCOMPARE(p_maze.getExits(i, j), prepared.getExits(i, j));
+            QCOMPARE(p_maze.getGhostExits(i, j), prepared.getGhostExits(i, j));
+
+            // The flow field : the same distances, and each direction leads one step closer to the Ghost camp
+            const int distance = p_maze.getDistanceToGhostCamp(i, j);
+            QCOMPARE(distance, prepared.getDistanceToGhostCamp(i, j));
+            if (distance > 0) {
+                const int next = p_maze.getNeighbourIndex(index, p_maze.getDirectionToGhostCamp(i, j));
+                QVERIFY(next != -1);
+                QCOMPARE(p_maze.getDistanceToGhostCamp(p_maze.getRowFromIndex(next), p_maze.getColumnFromIndex(next)), distance - 1);
+            }
+        }
+    }
+
+    // The paths between every two open Cells have the same length
+    for (int from = 0; from < NB_ROWS * NB_COLUMNS; ++from) {
+        if (p_maze.getCellType(from) == Cell::WALL) {
+            continue;
+        }
+        for (int to = 0; to < NB_ROWS * NB_COLUMNS; ++to) {
+            if (p_maze.getCellType(to) == Cell::WALL) {
+                continue;
+            }
+            const int fromRow = p_maze.getRowFromIndex(from);
+            const int fromColumn = p_maze.getColumnFromIndex(from);
+            const int toRow = p_maze.getRowFromIndex(to);
+            const int toColumn = p_maze.getColumnFromIndex(to);
+            QCOMPARE(p_maze.findPath(fromRow, fromColumn, toRow, toColumn).size(),
+                     prepared.findPath(fromRow, fromColumn, toRow, toColumn).size());
+        }
+    }
+}
+
+void MazeTest::compareWithBuilt(const Maze &p_maze, const ClusterGraph &p_clusterGraph) const
+{
+    ClusterGraph built;
+    built.build(&p_maze);
+
+    const int nbCells = p_maze.getNbRows() * p_maze.getNbColumns();
+    int nbOpen = 0;
+    for (int to = 0; to < nbCells; ++to) {
+        if (p_maze.getCellType(to) == Cell::WALL || nbOpen++ % CLUSTER_TARGET_PERIOD != 0) {
+            continue;
+        }
+        for (int from = 0; from < nbCells; ++from) {
+            if (p_maze.getCellType(from) == Cell::WALL) {
+                continue;
+            }
+            const int fromRow = p_maze.getRowFromIndex(from);
+            const int fromColumn = p_maze.getColumnFromIndex(from);
+            const int toRow = p_maze.getRowFromIndex(to);
+            const int toColumn = p_maze.getColumnFromIndex(to);
+            QCOMPARE(p_clusterGraph.findPath(fromRow, fromColumn, toRow, toColumn).size(),
+                     built.findPath(fromRow, fromColumn, toRow, toColumn).size());
+        }
+    }
+}
+
+void MazeTest::testChangeCell()
+{
+    Maze maze;
+    initMaze(maze);
+    maze.prepare();
+
+    for (int i = 0; i < NB_ROWS; ++i) {
+        for (int j = 0; j < NB_COLUMNS; ++j) {
+            if (i == RESURRECTION_ROW && j == RESURRECTION_COLUMN) {
+                continue;
+            }
+            const Cell::Type type = maze.getCellType(i, j);
+            if (type == Cell::WALL) {
+                maze.openCell(i, j);
+            } else {
+                maze.closeCell(i, j);
+            }
+            compareWithPrepared(maze);
+            if (QTest::currentTestFailed()) {
+                qWarning() << "After changing the Cell" << i << j;
+                return;
+            }
+            if (type == Cell::WALL) {
+                maze.closeCell(i, j);
+            } else {
+                maze.openCell(i, j);
+            }
+            compareWithPrepared(maze);
+            if (QTest::currentTestFailed()) {
+                qWarning() << "After restoring the Cell" << i << j;
+                return;
+            }
+        }
+    }
+}
+
+void MazeTest::testUpdateClusterGraph()
+{
+    // The Maze is too small to build its own ClusterGraph
+    Maze maze;
+    initMaze(maze, NB_CLUSTER_TILES);
+    maze.prepare();
+    ClusterGraph clusterGraph;
+    clusterGraph.build(&maze);
+
+    const int nbCells = maze.getNbRows() * maze.getNbColumns();
+    QVector<int> neighbours(nbCells * 4);
+    for (int i = 0; i < maze.getNbRows(); ++i) {
+        for (int j = 0; j < maze.getNbColumns(); ++j) {
+            if (i == RESURRECTION_ROW && j == RESURRECTION_COLUMN) {
+                continue;
+            }
+            const int index = maze.getCellIndex(i, j);
+            // Change the Cell, then restore it
+            for (int restore = 0; restore < 2; ++restore) {
+                for (int k = 0; k < nbCells * 4; ++k) {
+                    neighbours[k] = maze.getNeighbourIndex(k / 4, DIRECTIONS[k % 4]);
+                }
+                if (maze.getCellType(i, j) == Cell::WALL) {
+                    maze.openCell(i, j);
+                } else {
+                    maze.closeCell(i, j);
+                }
+                // Update the graph as the Maze does : around the Cell, and around the Cells a changed tunnel has linked or unlinked
+                clusterGraph.update(index);
+                for (int k = 0; k < nbCells * 4; ++k) {
+                    if (maze.getNeighbourIndex(k / 4, DIRECTIONS[k % 4]) != neighbours[k] && k / 4 != index) {
+                        clusterGraph.update(k / 4);
+                    }
+                }
+                compareWithBuilt(maze, clusterGraph);
+                if (QTest::currentTestFailed()) {
+                    qWarning() << (restore == 0 ? "After changing the Cell" : "After restoring the Cell") << i << j;
+                    return;
+                }
+            }
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(MazeTest)
+
+#include "mazetest.moc"
@@ -0,0 +1,576 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "benchmark.h"
+#include "clustergraph.h"
+#include "gamestate.h"
+#include "maze.h"
+#include "pathfinder.h"
+#include "randomgenerator.h"
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QPoint>
+#include <QTextStream>
+#include <QVector>
+
+#include <stdlib.h>
+
+namespace
+{
+/** The minimum duration of a measure, in nanoseconds */
+const qint64 MIN_DURATION = 200000000;
+
+/** The smallest and the largest side of the generated Mazes, in Cells */
+const int MIN_GENERATED_SIZE = 32;
+const int MAX_GENERATED_SIZE = 4096;
+
+/** The number of paths searched on each generated Maze */
+const int NB_GENERATED_QUERIES = 100;
+
+/** The chance a wall between two corridors of a generated Maze is opened, to make loops, is one in this number */
+const int GENERATED_LOOP_PERIOD = 8;
+
+/** The number of ticks played before copying the GameState, so that some of the things to eat are gone */
+const int NB_SNAPSHOT_TICKS = 1000;
+
+/** The number of copies between two readings of the clock, a copy being too short to be timed alone */
+const int NB_COPIES_PER_ROUND = 1000;
+
+/** The number of ticks between two readings of the clock, and the number of ticks the Cell reads are counted on */
+const int NB_TICKS_PER_ROUND = 10000;
+
+/** The chance the player asks for a Direction at a tick is one in this number */
+const int INPUT_PERIOD = 8;
+
+/** The Directions the random inputs are chosen from */
+const Maze::Direction DIRECTIONS[] = {Maze::UP, Maze::RIGHT, Maze::DOWN, Maze::LEFT};
+
+/**
+ * @brief A Cell as the Maze stored it before its flat arrays : its type, the Element on it, and the cost and the parent
+ * of the path search. The Maze kept an array of pointers to its rows, and Maze::getCell() returned a copy of the Cell.
+ */
+struct CellCopy {
+    Cell::Type type;
+    void *element;
+    int cost;
+    CellCopy *parent;
+};
+
+/** The bytes read by each Maze::getCell() call of the Cell copies : the row pointer and the Cell */
+const int CELL_COPY_BYTES = sizeof(CellCopy *) + sizeof(CellCopy);
+
+/**
+ * The most bytes Maze::isInLineSight() reads : the segment of the Ghost, the segments of the Kapman Cell along both axes,
+ * whether the segment is a loop, the Direction it is numbered along and the positions of both Cells on it
+ */
+const int LINE_SIGHT_BYTES = 3 * sizeof(int) + sizeof(bool) + sizeof(quint8) + 2 * sizeof(int);
+
+/**
+ * @brief The Cells the movement code reads during a tick, with the Cell copies and with the flat arrays.
+ */
+struct CellReads {
+    /** The number of Maze::getCell() calls of the Cell copies */
+    qint64 nbCopies;
+    /** The number of lookups in the flat arrays, a search of the line of sight counting as one */
+    qint64 nbLookups;
+    /** The bytes read from the flat arrays */
+    qint64 nbBytes;
+};
+
+/** The ways to search a path */
+enum Search {
+    LIST_SEARCH,        // The search Maze::getPathToGhostCamp() used before the PathFinder
+    PATH_FINDER,
+    CLUSTER_GRAPH
+};
+
+/** The names of the ways to search a path, in the Search order */
+const char *const SEARCH_NAMES[] = {"list search", "PathFinder", "ClusterGraph"};
+
+/** The ways to copy the GameState and to go back to a copy */
+enum Copy {
+    SAVE_SNAPSHOT,
+    RESTORE_SNAPSHOT,
+    SAVE_STATE,
+    RESTORE_STATE
+};
+
+/** The names of the ways to copy the GameState, in the Copy order */
+const char *const COPY_NAMES[] = {"saveSnapshot", "restoreSnapshot", "saveState", "restoreState"};
+
+/**
+ * @brief The result of the measure of a way to search paths.
+ */
+struct PathMeasure {
+    /** The mean duration of a search, in nanoseconds */
+    double duration;
+    /** The number of paths found */
+    int nbFound;
+    /** The mean length of the paths found, in Cells */
+    double length;
+};
+
+/**
+ * Searches a path as Maze::getPathToGhostCamp() did before the PathFinder : the open and closed lists are QLists searched with contains(),
+ * the next Cell being the one of the open list closest to the target whatever the way already done.
+ * The cost and the parent of each Cell are kept in the given arrays rather than in the Cells. The search gives up as it did,
+ * once a Cell adds nothing to the open list.
+ */
+QList<QPoint> findListPath(const Maze *p_maze, const int p_from, const int p_to, QVector<int> &p_costs, QVector<int> &p_parents)
+{
+    // The moves to the 4 neighbours of a Cell, in the order they were tried
+    static const QPoint moves[4] = {QPoint(-1, 0), QPoint(1, 0), QPoint(0, -1), QPoint(0, 1)};
+
+    QList<QPoint> path;
+    QList<QPoint> openList;
+    QList<QPoint> closedList;
+    const QPoint target = p_maze->getCoords(p_to);
+    QPoint currentCell;
+    int icurrent = 0;
+    int oldSize = 0;
+
+    p_costs[p_from] = abs(target.y() - p_maze->getRowFromIndex(p_from)) + abs(target.x() - p_maze->getColumnFromIndex(p_from));
+    openList.append(p_maze->getCoords(p_from));
+    while (!closedList.contains(target) && openList.size() != oldSize) {
+        // Look for the lowest cost cell on the open list
+        int lowestCost = p_maze->getNbRows() + p_maze->getNbColumns();
+        for (int i = 0; i < openList.size(); ++i) {
+            const int cost = p_costs[p_maze->getCellIndex(openList[i].y(), openList[i].x())];
+            if (cost < lowestCost) {
+                lowestCost = cost;
+                currentCell = openList[i];
+                icurrent = i;
+            }
+        }
+        // Switch this cell to the closed list
+        closedList.append(currentCell);
+        openList.removeAt(icurrent);
+        oldSize = openList.size();
+        for (int i = 0; i < 4; ++i) {
+            const QPoint cell = currentCell + moves[i];
+            if (p_maze->getCellType(cell.y(), cell.x()) != Cell::WALL && !closedList.contains(cell) && !openList.contains(cell)) {
+                const int index = p_maze->getCellIndex(cell.y(), cell.x());
+                p_costs[index] = abs(target.y() - cell.y()) + abs(target.x() - cell.x());
+                p_parents[index] = p_maze->getCellIndex(currentCell.y(), currentCell.x());
+                openList.append(cell);
+            }
+        }
+    }
+    if (!closedList.contains(target)) {
+        return path;
+    }
+    for (int cell = p_to; cell != p_from; cell = p_parents[cell]) {
+        path.prepend(p_maze->getCoords(cell));
+    }
+    return path;
+}
+
+/**
+ * Searches the paths between the given pairs of Cells, again and again until the measure has lasted long enough.
+ */
+PathMeasure measurePaths(const Maze *p_maze, const QVector<QPair<int, int> > &p_queries, const Search p_search, const ClusterGraph *p_clusterGraph = NULL)
+{
+    const int nbCells = p_maze->getNbRows() * p_maze->getNbColumns();
+    QVector<int> costs(nbCells);
+    QVector<int> parents(nbCells);
+    PathFinder pathFinder;
+    PathMeasure measure;
+    qint64 nbSearches = 0;
+    qint64 length = 0;
+    QElapsedTimer clock;
+
+    measure.nbFound = 0;
+    clock.start();
+    do {
+        for (int i = 0; i < p_queries.size(); ++i) {
+            const int from = p_queries[i].first;
+            const int to = p_queries[i].second;
+            QList<QPoint> path;
+            switch (p_search) {
+            case LIST_SEARCH:
+                path = findListPath(p_maze, from, to, costs, parents);
+                break;
+            case PATH_FINDER:
+                path = pathFinder.findPath(p_maze, p_maze->getRowFromIndex(from), p_maze->getColumnFromIndex(from),
+                                           p_maze->getRowFromIndex(to), p_maze->getColumnFromIndex(to));
+                break;
+            case CLUSTER_GRAPH:
+                path = p_clusterGraph->findPath(p_maze->getRowFromIndex(from), p_maze->getColumnFromIndex(from),
+                                                p_maze->getRowFromIndex(to), p_maze->getColumnFromIndex(to));
+                break;
+            }
+            // The paths are the same from a round to the next one
+            if (nbSearches < p_queries.size() && !path.isEmpty()) {
+                ++measure.nbFound;
+                length += path.size();
+            }
+            ++nbSearches;
+        }
+    } while (clock.nsecsElapsed() < MIN_DURATION);
+    measure.duration = double(clock.nsecsElapsed()) / nbSearches;
+    measure.length = measure.nbFound > 0 ? double(length) / measure.nbFound : 0.0;
+    return measure;
+}
+
+/**
+ * Copies a GameState or goes back to a copy, again and again until the measure has lasted long enough.
+ * @return the mean duration of a copy, in nanoseconds
+ */
+double measureCopies(GameState &p_gameState, const Copy p_copy, QByteArray &p_snapshot, const QByteArray &p_state)
+{
+    qint64 nbCopies = 0;
+    QElapsedTimer clock;
+
+    clock.start();
+    do {
+        for (int i = 0; i < NB_COPIES_PER_ROUND; ++i) {
+            switch (p_copy) {
+            case SAVE_SNAPSHOT:
+                // The memory of the snapshot is reused from a copy to the next one
+                p_snapshot.resize(p_gameState.getSnapshotSize());
+                p_gameState.saveSnapshot(p_snapshot.data());
+                break;
+            case RESTORE_SNAPSHOT:
+                p_gameState.restoreSnapshot(p_snapshot.constData(), p_snapshot.size());
+                break;
+            case SAVE_STATE:
+                p_snapshot = p_gameState.saveState();
+                break;
+            case RESTORE_STATE:
+                p_gameState.restoreState(p_state);
+                break;
+            }
+        }
+        nbCopies += NB_COPIES_PER_ROUND;
+    } while (clock.nsecsElapsed() < MIN_DURATION);
+    return double(clock.nsecsElapsed()) / nbCopies;
+}
+
+/**
+ * Chooses the input of the next tick : most of the time none, else a random Direction.
+ */
+Maze::Direction chooseInput(RandomGenerator &p_policy)
+{
+    return p_policy.bounded(INPUT_PERIOD) == 0 ? DIRECTIONS[p_policy.bounded(4)] : Maze::NONE;
+}
+
+/**
+ * Goes on after the deaths and the levels of the last tick as the Game does.
+ */
+void goOn(GameState &p_gameState)
+{
+    const QVector<GameState::Event> &events = p_gameState.getEvents();
+    for (int i = 0; i < events.size(); ++i) {
+        if ((events[i].type == GameState::KAPMAN_DEATH && p_gameState.getLives() > 0) || events[i].type == GameState::LEVEL_COMPLETED) {
+            p_gameState.initCharacters();
+        }
+    }
+}
+
+/**
+ * Checks whether a Cell of a Maze is a corridor, the Cells out of the Maze being walls.
+ */
+bool isCorridor(const Maze *p_maze, const int p_row, const int p_column)
+{
+    return p_row >= 0 && p_row < p_maze->getNbRows() && p_column >= 0 && p_column < p_maze->getNbColumns()
+           && p_maze->getCellType(p_row, p_column) == Cell::CORRIDOR;
+}
+
+/**
+ * Moves Cell coordinates by one Cell in a Direction.
+ */
+void moveCell(const Maze::Direction p_direction, int &p_row, int &p_column)
+{
+    switch (p_direction) {
+    case Maze::UP:
+        --p_row;
+        break;
+    case Maze::DOWN:
+        ++p_row;
+        break;
+    case Maze::LEFT:
+        --p_column;
+        break;
+    case Maze::RIGHT:
+        ++p_column;
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * Counts the Cells the Kapman reads to choose its Direction, as Kapman::updateMove() did with the Cell copies
+ * and as GameState::updateKapman() does with the Cell exits.
+ */
+void countKapmanReads(const Maze *p_maze, const GameState::KapmanData &p_kapman, const Maze::Direction p_asked, CellReads &p_reads)
+{
+    const Maze::Direction direction = p_kapman.direction;
+    const int row = Maze::getRowFromY(p_kapman.y);
+    const int column = Maze::getColFromX(p_kapman.x);
+    int askedRow = row;
+    int askedColumn = column;
+    moveCell(p_asked, askedRow, askedColumn);
+
+    ++p_reads.nbLookups;
+    p_reads.nbBytes += sizeof(quint8);
+    if (direction == Maze::NONE) {
+        // The next Cell in the asked Direction
+        p_reads.nbCopies += p_asked != Maze::NONE ? 1 : 0;
+    } else if (p_asked != Maze::NONE && p_asked == Maze::getOppositeDirection(direction)) {
+        // The next Cell, only on a Cell center
+        p_reads.nbCopies += GameState::isOnCenter(p_kapman.x, p_kapman.y) ? 1 : 0;
+    } else if (GameState::onCenter(p_kapman.x, p_kapman.y, direction, p_kapman.speed)) {
+        // The next Cell in the asked Direction, then the next one in the current Direction if the Kapman cannot turn
+        if (p_asked != Maze::NONE && p_asked != direction) {
+            p_reads.nbCopies += isCorridor(p_maze, askedRow, askedColumn) ? 1 : 2;
+        } else {
+            p_reads.nbCopies += 1;
+        }
+    }
+}
+
+/**
+ * Counts the Cells a Ghost reads to choose its Direction, as Game::update() and Ghost::updateMove() did with the Cell copies
+ * and as GameState::updateGhosts() does with the segments and the Cell exits.
+ */
+void countGhostReads(const Maze *p_maze, const GameState::GhostData &p_ghost, const int p_kapmanRow, const int p_kapmanColumn, CellReads &p_reads)
+{
+    const int row = Maze::getRowFromY(p_ghost.y);
+    const int column = Maze::getColFromX(p_ghost.x);
+    const bool centered = GameState::onCenter(p_ghost.x, p_ghost.y, p_ghost.direction, p_ghost.speed);
+    const QPoint camp = p_maze->getResurrectionCell();
+
+    // The hunters looked for the Kapman at every tick, through the Cells between them when it was ahead on the same row or column
+    bool inSight = false;
+    if (p_ghost.state == GameState::HUNTER) {
+        const bool horizontal = row == p_kapmanRow && column != p_kapmanColumn
+                                && (p_ghost.direction == (column > p_kapmanColumn ? Maze::LEFT : Maze::RIGHT));
+        const bool vertical = column == p_kapmanColumn && row != p_kapmanRow
+                              && (p_ghost.direction == (row > p_kapmanRow ? Maze::UP : Maze::DOWN));
+        if (horizontal || vertical) {
+            const int first = horizontal ? qMin(column, p_kapmanColumn) : qMin(row, p_kapmanRow);
+            const int last = horizontal ? qMax(column, p_kapmanColumn) : qMax(row, p_kapmanRow);
+            inSight = true;
+            for (int i = first; i < last && inSight; ++i) {
+                ++p_reads.nbCopies;
+                inSight = horizontal ? isCorridor(p_maze, row, i) : isCorridor(p_maze, i, column);
+            }
+        }
+    }
+    if (p_ghost.state != GameState::EATEN && centered && !inSight) {
+        // Each neighbour, then the Cell of the Ghost and the neighbour again if the neighbour was not a corridor
+        const bool inCamp = p_maze->getCellType(row, column) == Cell::GHOSTCAMP;
+        for (int i = 0; i < 4; ++i) {
+            int nextRow = row;
+            int nextColumn = column;
+            moveCell(DIRECTIONS[i], nextRow, nextColumn);
+            p_reads.nbCopies += isCorridor(p_maze, nextRow, nextColumn) ? 1 : (inCamp ? 3 : 2);
+        }
+    }
+
+    // Now only the Ghosts on a Cell center choose their Direction
+    if (!centered) {
+        return;
+    }
+    if (p_ghost.state == GameState::HUNTER) {
+        ++p_reads.nbLookups;
+        p_reads.nbBytes += LINE_SIGHT_BYTES;
+        if (p_maze->isInLineSight(row, column, p_ghost.direction, p_kapmanRow, p_kapmanColumn)) {
+            return;
+        }
+    }
+    // The exits of the Cell, or the Direction to the camp for an eaten Ghost which has not reached it
+    if (p_ghost.state != GameState::EATEN || row != camp.y() || column != camp.x()) {
+        ++p_reads.nbLookups;
+        p_reads.nbBytes += sizeof(quint8);
+    }
+}
+
+/**
+ * Fills a square Maze with a generated labyrinth : corridors one Cell wide on the odd rows and columns, linked as a tree
+ * with some more walls opened to make loops, the Ghost camp in the middle and no tunnel.
+ */
+void generateMaze(Maze &p_maze, const int p_size, RandomGenerator &p_random)
+{
+    p_maze.init(p_size, p_size);
+    for (int row = 1; row < p_size - 1; row += 2) {
+        for (int column = 1; column < p_size - 1; column += 2) {
+            p_maze.setCellType(row, column, Cell::CORRIDOR);
+            // Link each crossing to the one above or on the left, so that all of them can be reached
+            if (row > 1 && (column == 1 || p_random.bounded(2) == 0)) {
+                p_maze.setCellType(row - 1, column, Cell::CORRIDOR);
+            } else if (column > 1) {
+                p_maze.setCellType(row, column - 1, Cell::CORRIDOR);
+            }
+            if (row > 1 && column > 1 && p_random.bounded(GENERATED_LOOP_PERIOD) == 0) {
+                p_maze.setCellType(row - 1, column, Cell::CORRIDOR);
+                p_maze.setCellType(row, column - 1, Cell::CORRIDOR);
+            }
+        }
+    }
+    const int middle = p_size / 2 | 1;
+    p_maze.setCellType(middle, middle, Cell::GHOSTCAMP);
+    p_maze.setResurrectionCell(QPoint(middle, middle));
+    p_maze.prepare();
+}
+}
+
+void Benchmark::runPaths(QTextStream &p_stream, const Maze *p_maze)
+{
+    // From every Cell an eaten Ghost can be on, to the camp
+    const QPoint camp = p_maze->getResurrectionCell();
+    const int target = p_maze->getCellIndex(camp.y(), camp.x());
+    QVector<QPair<int, int> > queries;
+    for (int i = 0; i < p_maze->getNbRows() * p_maze->getNbColumns(); ++i) {
+        if (p_maze->getCellType(i) != Cell::WALL && i != target) {
+            queries.append(qMakePair(i, target));
+        }
+    }
+
+    p_stream.setRealNumberNotation(QTextStream::FixedNotation);
+    p_stream.setRealNumberPrecision(1);
+    p_stream << "# Paths to the Ghost camp from the " << queries.size() << " Cells of a " << p_maze->getNbRows() << 'x' << p_maze->getNbColumns() << " Maze\n";
+    p_stream << "search\tns/path\tfound\tmean length\n";
+    for (int search = LIST_SEARCH; search <= PATH_FINDER; ++search) {
+        const PathMeasure measure = measurePaths(p_maze, queries, Search(search));
+        p_stream << SEARCH_NAMES[search] << '\t' << measure.duration << '\t' << measure.nbFound << '\t' << measure.length << '\n';
+    }
+}
+
+void Benchmark::runHierarchy(QTextStream &p_stream)
+{
+    RandomGenerator random(1);
+
+    p_stream.setRealNumberNotation(QTextStream::FixedNotation);
+    p_stream.setRealNumberPrecision(1);
+    p_stream << "# Paths between " << NB_GENERATED_QUERIES << " pairs of random Cells of generated Mazes, "
+             << ClusterGraph::CLUSTER_SIZE << 'x' << ClusterGraph::CLUSTER_SIZE << " Cells per cluster\n";
+    p_stream << "size\tprepare ms\tbuild ms\tPathFinder us/path\tClusterGraph us/path\tlength ratio\n";
+    for (int size = MIN_GENERATED_SIZE; size <= MAX_GENERATED_SIZE; size *= 2) {
+        Maze maze;
+        QElapsedTimer clock;
+        clock.start();
+        generateMaze(maze, size, random);
+        const qint64 prepareDuration = clock.nsecsElapsed();
+        // Build the graph whatever the size, the Maze only building its own one from Maze::HIERARCHICAL_MIN_CELLS
+        ClusterGraph clusterGraph;
+        clock.start();
+        clusterGraph.build(&maze);
+        const qint64 buildDuration = clock.nsecsElapsed();
+
+        // The corridor Cells are on the odd rows and columns
+        QVector<QPair<int, int> > queries;
+        while (queries.size() < NB_GENERATED_QUERIES) {
+            const int from = maze.getCellIndex(random.bounded(size / 2 - 1) * 2 + 1, random.bounded(size / 2 - 1) * 2 + 1);
+            const int to = maze.getCellIndex(random.bounded(size / 2 - 1) * 2 + 1, random.bounded(size / 2 - 1) * 2 + 1);
+            if (from != to) {
+                queries.append(qMakePair(from, to));
+            }
+        }
+        const PathMeasure flat = measurePaths(&maze, queries, PATH_FINDER);
+        const PathMeasure hierarchical = measurePaths(&maze, queries, CLUSTER_GRAPH, &clusterGraph);
+        p_stream << size << 'x' << size << '\t' << prepareDuration / 1000000.0 << '\t' << buildDuration / 1000000.0 << '\t'
+                 << flat.duration / 1000.0 << '\t' << hierarchical.duration / 1000.0 << '\t';
+        // The hierarchical paths are only a little longer
+        p_stream.setRealNumberPrecision(3);
+        p_stream << (flat.length > 0.0 ? hierarchical.length / flat.length : 0.0) << '\n';
+        p_stream.setRealNumberPrecision(1);
+        p_stream.flush();
+    }
+}
+
+void Benchmark::runSnapshots(QTextStream &p_stream, const GameState *p_gameState)
+{
+    // Play with random inputs first, going on after the deaths and the levels as the Game does
+    GameState gameState(*p_gameState);
+    RandomGenerator policy(1);
+    while (gameState.getTick() < NB_SNAPSHOT_TICKS && gameState.getLives() > 0) {
+        gameState.step(chooseInput(policy));
+        goOn(gameState);
+    }
+
+    QByteArray snapshot(gameState.getSnapshotSize(), 0);
+    gameState.saveSnapshot(snapshot.data());
+    const QByteArray state = gameState.saveState();
+    p_stream.setRealNumberNotation(QTextStream::FixedNotation);
+    p_stream.setRealNumberPrecision(1);
+    p_stream << "# Copies of the GameState after " << gameState.getTick() << " ticks, with " << gameState.getNbGhosts() << " Ghosts\n";
+    p_stream << "copy\tns/copy\tbytes\n";
+    for (int copy = SAVE_SNAPSHOT; copy <= RESTORE_STATE; ++copy) {
+        QByteArray copied = copy <= RESTORE_SNAPSHOT ? snapshot : state;
+        const double duration = measureCopies(gameState, Copy(copy), copied, state);
+        p_stream << COPY_NAMES[copy] << '\t' << duration << '\t' << (copy <= RESTORE_SNAPSHOT ? snapshot.size() : state.size()) << '\n';
+    }
+}
+
+void Benchmark::runTicks(QTextStream &p_stream, const Maze *p_maze, const GameState *p_gameState)
+{
+    // Count the Cell reads of some ticks, playing with random inputs and starting a new game once the Kapman has no life left
+    GameState gameState(*p_gameState);
+    RandomGenerator policy(1);
+    CellReads reads;
+    reads.nbCopies = 0;
+    reads.nbLookups = 0;
+    reads.nbBytes = 0;
+    for (int i = 0; i < NB_TICKS_PER_ROUND; ++i) {
+        const Maze::Direction input = chooseInput(policy);
+        const GameState::KapmanData &kapman = gameState.getKapman();
+        const int kapmanRow = Maze::getRowFromY(kapman.y);
+        const int kapmanColumn = Maze::getColFromX(kapman.x);
+        // The Ghosts move first, seeing the Kapman where it was at the end of the last tick
+        for (int ghost = 0; ghost < gameState.getNbGhosts(); ++ghost) {
+            countGhostReads(p_maze, gameState.getGhost(ghost), kapmanRow, kapmanColumn, reads);
+        }
+        countKapmanReads(p_maze, kapman, input != Maze::NONE ? input : kapman.askedDirection, reads);
+        gameState.step(input);
+        goOn(gameState);
+        if (gameState.getLives() == 0) {
+            gameState = *p_gameState;
+        }
+    }
+
+    // Then play the same ticks again until the measure has lasted long enough
+    qint64 nbTicks = 0;
+    QElapsedTimer clock;
+    clock.start();
+    do {
+        gameState = *p_gameState;
+        policy.seed(1);
+        for (int i = 0; i < NB_TICKS_PER_ROUND; ++i) {
+            gameState.step(chooseInput(policy));
+            goOn(gameState);
+            if (gameState.getLives() == 0) {
+                gameState = *p_gameState;
+            }
+        }
+        nbTicks += NB_TICKS_PER_ROUND;
+    } while (clock.nsecsElapsed() < MIN_DURATION);
+    const double duration = double(clock.nsecsElapsed()) / nbTicks;
+
+    p_stream.setRealNumberNotation(QTextStream::FixedNotation);
+    p_stream.setRealNumberPrecision(1);
+    p_stream << "# " << NB_TICKS_PER_ROUND << " ticks on a " << p_maze->getNbRows() << 'x' << p_maze->getNbColumns() << " Maze with "
+             << p_gameState->getNbGhosts() << " Ghosts, " << duration << " ns/tick\n";
+    p_stream << "storage\tbytes/tick\treads/tick\n";
+    p_stream << "Cell copies\t" << double(reads.nbCopies * CELL_COPY_BYTES) / NB_TICKS_PER_ROUND << '\t'
+             << double(reads.nbCopies) / NB_TICKS_PER_ROUND << '\n';
+    p_stream << "flat arrays\t" << double(reads.nbBytes) / NB_TICKS_PER_ROUND << '\t' << double(reads.nbLookups) / NB_TICKS_PER_ROUND << '\n';
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+class GameState;
+class Maze;
+class QTextStream;
+
+/**
+ * @brief This class measures the parts of the game that run without drawing, for kapman-sim.
+ *
+ * Each measure repeats its work until it has lasted long enough to be timed,
+ * and writes its results as tab-separated lines, one per case measured.
+ */
+class Benchmark
+{
+
+public:
+
+    /**
+     * Measures the search of the paths to the Ghost camp from every Cell of a Maze,
+     * with the PathFinder and with the search Maze::getPathToGhostCamp() used before it.
+     * @param p_stream the stream to write the results to
+     * @param p_maze the Maze, once prepared
+     */
+    static void runPaths(QTextStream &p_stream, const Maze *p_maze);
+
+    /**
+     * Measures the search of paths between random Cells of generated Mazes from 32x32 to 4096x4096 Cells,
+     * with the PathFinder on all the Cells and with the hierarchical search of the ClusterGraph.
+     * @param p_stream the stream to write the results to
+     */
+    static void runHierarchy(QTextStream &p_stream);
+
+    /**
+     * Measures the copies of a GameState played for a while : the plain-data snapshots, and the compact states
+     * which the Recording keeps as keyframes.
+     * @param p_stream the stream to write the results to
+     * @param p_gameState the GameState before the first tick
+     */
+    static void runSnapshots(QTextStream &p_stream, const GameState *p_gameState);
+
+    /**
+     * Measures the ticks of a GameState played with random inputs, and counts the bytes the movement code reads from the Maze
+     * to choose the Directions : from the flat arrays, and from the Cell copies Maze::getCell() returned before them.
+     * @param p_stream the stream to write the results to
+     * @param p_maze the Maze the game is played on
+     * @param p_gameState the GameState before the first tick
+     */
+    static void runTicks(QTextStream &p_stream, const Maze *p_maze, const GameState *p_gameState);
+};
+
+#endif
@@ -19,7 +19,6 @@
  */
 
 #include "bonus.h"
-#include "kapman.h"
 
 Bonus::Bonus(qreal p_x, qreal p_y, Maze *p_maze, int p_points) : Element(p_x, p_y, p_maze)
 {
@@ -32,11 +31,6 @@ Bonus::~Bonus()
 
 }
 
-void Bonus::doActionOnCollision(Kapman *p_kapman)
-{
-    p_kapman->winPoints(this);
-}
-
 void Bonus::setPoints(const int p_points)
 {
     m_points = p_points;
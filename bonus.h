@@ -45,12 +45,6 @@ public:
      */
     ~Bonus();
 
-    /**
-     * Computes an action on a collision with the Kapman.
-     * @param p_kapman the Kapman instance that collides with the Bonus
-     */
-    void doActionOnCollision(Kapman *p_kapman) Q_DECL_OVERRIDE;
-
     /**
      * Sets the given value to the Bonus.
      * @param p_points the value of the Bonus
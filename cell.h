@@ -20,19 +20,29 @@
 
 #include <QtGlobal>
 
-class Element;
-
 /**
- * @brief This class represents a Cell of the Maze.
+ * @brief This class gathers the properties of the Cells of the Maze.
+ * The Cells themselves are stored by the Maze, see Maze::getCellType().
  */
 class Cell
 {
 
 public:
 
-    /** The Cell side size */
+    /** The Cell side size, in pixels */
     static const qreal SIZE;
 
+    /**
+     * The fixed-point coordinates of the game : a Cell side is divided into SUBCELLS units,
+     * so that the Cell of a coordinate is a shift and the position inside the Cell a mask.
+     */
+    enum FixedPoint {
+        SUBCELL_BITS = 8,                   // The number of bits of the position inside a Cell
+        SUBCELLS = 1 << SUBCELL_BITS,       // The number of units of a Cell side
+        SUBCELL_MASK = SUBCELLS - 1,        // The mask of the position inside a Cell
+        CENTER = SUBCELLS / 2               // The position of the Cell center inside the Cell
+    };
+
     /** The Cell possible types */
     enum Type {
         WALL = 0,
@@ -40,79 +50,12 @@ public:
         GHOSTCAMP = 2
     };
 
-private:
-
-    /** The Cell type */
-    Type m_type;
-
-    /** A reference on the Element that is on the Cell */
-    Element *m_element;
-
-    /** Cost used in A* pathfinding algorithm : lower is the cost, closer to the target Cell is this Cell */
-    int m_cost;
-
-    /** Parent node used in A* pathfinding algorithm : the Cell which enables to go to this Cell */
-    Cell *m_parent;
-
-public:
-
-    /**
-     * Creates a new Cell instance.
-     */
-    Cell();
-
-    /**
-     * Deletes the Cell instance.
-     */
-    ~Cell();
-
-    /**
-     * Gets the Cell type.
-     * @return the Cell type
-     */
-    Type getType() const;
-
-    /**
-     * Sets the Cell type.
-     * @param p_type the new type to set
-     */
-    void setType(Type p_type);
-
-    /**
-     * Gets the Element that is on the Cell.
-     * @return the Element that is on the Cell
-     */
-    Element *getElement() const;
-
-    /**
-     * Sets the Element that is on the Cell.
-     * @param p_element the Element to set on the Cell
-     */
-    void setElement(Element *p_element);
-
-    /**
-     * Gets the Cell cost for A* pathfinding algorithm.
-     * @return the Cell cost for A* pathfinding algorithm
-     */
-    int getCost() const;
-
-    /**
-     * Sets a cost for the Cell, for A* pathfinding algorithm.
-     * @param p_cost the cost of the Cell for A* pathfinding algorithm
-     */
-    void setCost(const int p_cost);
-
-    /**
-     * Gets the parent Cell of this Cell for A* pathfinding algorithm.
-     * @return the Cell parent for A* pathfinding algorithm
-     */
-    Cell *getParent() const;
-
     /**
-     * Sets the parent Cell of this Cell for A* pathfinding algorithm.
-     * @param p_parent the parent of the Cell for A* pathfinding algorithm
+     * Converts a fixed-point coordinate into pixels, to draw it.
+     * @param p_coordinate the coordinate, in SUBCELLS units per Cell
+     * @return the coordinate in pixels
      */
-    void setParent(Cell *p_parent);
+    static qreal toPixels(const int p_coordinate);
 };
 
 #endif
@@ -20,9 +20,13 @@
 #define CHARACTER_H
 
 #include "element.h"
+#include "gamestate.h"
 
 /**
- * @brief This class describes the common characteristics and behaviour of the game characters (Kapman and the Ghost).
+ * @brief This class describes the common characteristics of the game characters (Kapman and the Ghost) as shown on the scene.
+ *
+ * The characters are moved by the GameState : this class only mirrors their coordinates in pixels and their direction for the view,
+ * and tells the Game what has changed, so that the Game gathers the changes of a whole frame for the view.
  */
 class Character : public Element
 {
@@ -31,43 +35,24 @@ class Character : public Element
 
 public:
 
-    /** Speed on easy level */
-    static const qreal LOW_SPEED;
-
-    /** Speed on medium level */
-    static const qreal MEDIUM_SPEED;
-
-    /** Speed on hard level */
-    static const qreal HIGH_SPEED;
-
-    /** Speed increase on easy level (percentage)  */
-    static const qreal LOW_SPEED_INC;
-
-    /** Speed increase on medium level (percentage)  */
-    static const qreal MEDIUM_SPEED_INC;
-
-    /** Speed increase on hard level (percentage) */
-    static const qreal HIGH_SPEED_INC;
+    /** The changes of a Character the view has to show, as bits so that the changes of a frame can be combined */
+    enum Change {
+        NO_CHANGE = 0,
+        MOVED = 1,          // The Character has new coordinates
+        TURNED = 2,         // The Kapman has a new direction
+        STOPPED = 4,        // The Kapman has stopped moving
+        DIED = 8,           // The Kapman has been caught, and starts blinking
+        BLINKED = 16,       // The number of times the Character has blinked has changed
+        STATE_CHANGED = 32  // The Ghost has a new state
+    };
 
 protected:
 
-    /** The Character x-speed */
-    qreal m_xSpeed;
-
-    /** The Character y-speed */
-    qreal m_ySpeed;
-
-    /** The character speed */
-    qreal m_speed;
+    /** The Direction the Character moves to, Maze::NONE if it does not move */
+    Maze::Direction m_direction;
 
-    /** Reference to the speed of the character when in "normal" behaviour */
-    qreal m_normalSpeed;
-
-    /** The value the character's speed is incremented by when level up */
-    qreal m_speedIncrease;
-
-    /** The maximum character speed */
-    qreal m_maxSpeed;
+    /** The number of times the Character has blinked since it has started blinking */
+    int m_nbBlinks;
 
 public:
 
@@ -85,130 +70,42 @@ public:
     ~Character();
 
     /**
-     * Makes the Character go up.
-     */
-    virtual void goUp() = 0;
-
-    /**
-     * Makes the Character go down.
-     */
-    virtual void goDown() = 0;
-
-    /**
-     * Makes the Character go to the right.
+     * Updates the Character direction from its state in the GameState, after a tick.
+     * @param p_data the Character state
      */
-    virtual void goRight() = 0;
+    void update(const GameState::CharacterData &p_data);
 
     /**
-     * Makes the Character go to the left.
+     * Moves the Character between its coordinates before and after the last tick, to draw it between two ticks.
+     * @param p_data the Character state
+     * @param p_alpha the elapsed part of the tick, from 0 (before the tick) to 1 (after the tick)
+     * @return MOVED if the coordinates have changed, NO_CHANGE otherwise
      */
-    virtual void goLeft() = 0;
-
-    /**
-     * Updates the Character move.
-     */
-    virtual void updateMove() = 0;
-
-    /**
-     * Moves the Character function of its current coordinates and speed.
-     * If the character reaches a border, it circles around the maze and continue its way from the other side.
-     */
-    void move();
+    int updatePosition(const GameState::CharacterData &p_data, const qreal p_alpha);
 
     /**
      * Manages the character death (essentially blinking).
+     * @return DIED
      */
-    void die();
-
-    /**
-     * Gets the Character x-speed value.
-     * @return the x-speed value
-     */
-    qreal getXSpeed() const;
-
-    /**
-     * Gets the Character y-speed value.
-     * @return the y-speed value
-     */
-    qreal getYSpeed() const;
-
-    /**
-     * Gets the Character speed.
-     * @return the character speed
-     */
-    qreal getSpeed() const;
+    int die();
 
     /**
-     * Gets the Character normal speed.
-     * @return the character speed reference, when in "normal" behaviour
+     * Makes the Character blink, the blinks being counted in ticks by the Game so that they follow the simulated time.
+     * @param p_nbBlinks the number of times the Character has blinked since it has started blinking
+     * @return BLINKED if the number of blinks has changed, NO_CHANGE otherwise
      */
-    qreal getNormalSpeed() const;
+    int setNbBlinks(const int p_nbBlinks);
 
     /**
-     * Set the Character x-speed value.
-     * @param p_xSpeed the x-speed to set
+     * @return the number of times the Character has blinked since it has started blinking
      */
-    void setXSpeed(qreal p_xSpeed);
+    int getNbBlinks() const;
 
     /**
-     * Set the Character y-speed value.
-     * @param p_ySpeed the y-speed to set
+     * @return the Direction the Character moves to, Maze::NONE if it does not move
      */
-    void setYSpeed(qreal p_ySpeed);
-
-    /**
-     * Initializes the Character speed considering the difficulty level.
-     */
-    void initSpeed();
-
-    /**
-     * Checks the Character is in the line of sight of the given other Character.
-     * @param p_character the other Character
-     * @return true if the Character is in the same line than the given one
-     */
-    bool isInLineSight(Character *p_character);
-
-    /**
-     * Increases the Character speed with each level completed.
-     */
-    void increaseCharactersSpeed();
-
-protected:
-
-    /**
-     * Initializes the Character speed increment considering the difficulty level.
-     */
-    virtual void initSpeedInc() = 0;
-
-    /**
-     * Gets the next Cell the Character is going to reach.
-     * @return the next Cell the Character is going to reach
-     */
-    Cell getNextCell();
-
-    /**
-     * Checks the Character gets on a Cell center during its next movement.
-     * @return true if the Character is on a Cell center, false otherwise
-     */
-    bool onCenter();
-
-    /**
-     * Checks whether the Character is currently on a Cell center.
-     * @return true if the Character is on a Cell center, false otherwise
-     */
-    bool isOnCenter();
-
-    /**
-     * Moves the character on the center of its current Cell.
-     */
-    void moveOnCenter();
-
-signals:
-
-    /**
-     * Emitted when the character is eaten.
-     */
-    void eaten();
+    Maze::Direction getDirection() const;
 };
 
 #endif
+
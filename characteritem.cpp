@@ -17,26 +17,25 @@
 
 #include "characteritem.h"
 
-CharacterItem::CharacterItem(Character *p_model) : ElementItem(p_model)
+CharacterItem::CharacterItem(Character *p_model) : ElementItem(p_model), m_nbBlinks(0)
 {
-    connect(p_model, SIGNAL(eaten()), this, SLOT(startBlinking()));
 }
 
 CharacterItem::~CharacterItem()
 {
-    delete m_blinkTimer;
 }
 
-QPainterPath CharacterItem::shape() const
+void CharacterItem::applyChanges(const int p_changes)
 {
-    QPainterPath path;
-    // Temporary variable to keep the boundingRect available
-    QRectF rect = boundingRect();
-
-    // Calculation of the shape
-    QRectF shapeRect = QRectF(rect.x() + rect.width() / 4, rect.y() + rect.height() / 4, rect.width() / 2, rect.height() / 2);
-    path.addEllipse(shapeRect);
-    return path;
+    if (p_changes & Character::MOVED) {
+        update(getModel()->getX(), getModel()->getY());
+    }
+    if (p_changes & Character::DIED) {
+        startBlinking();
+    }
+    if (p_changes & Character::BLINKED) {
+        blink();
+    }
 }
 
 void CharacterItem::update(qreal p_x, qreal p_y)
@@ -51,11 +50,10 @@ void CharacterItem::update(qreal p_x, qreal p_y)
 void CharacterItem::startBlinking()
 {
     m_nbBlinks = 0;
-    m_blinkTimer->start();
 }
 
 void CharacterItem::blink()
 {
-    m_nbBlinks++;
+    m_nbBlinks = ((Character *)getModel())->getNbBlinks();
 }
 
@@ -21,8 +21,6 @@
 #include "elementitem.h"
 #include "character.h"
 
-#include <QTimer>
-
 /**
  * @brief This class is the graphical representation of a Character.
  */
@@ -33,10 +31,7 @@ class CharacterItem : public ElementItem
 
 protected:
 
-    /** Timer used to make the character blink */
-    QTimer *m_blinkTimer;
-
-    /** Number of ticks of the blink timer */
+    /** Number of times the character has blinked */
     int m_nbBlinks;
 
 public:
@@ -53,11 +48,10 @@ public:
     ~CharacterItem();
 
     /**
-     * Overrides the default shape function to make it a small circle
-     * This function is used to determinate collision between items
-     * @return QPainterPath the new shape of the Character
+     * Shows the changes of the Character since the previous frame.
+     * @param p_changes the Character::Change bits
      */
-    QPainterPath shape() const Q_DECL_OVERRIDE;
+    virtual void applyChanges(const int p_changes);
 
 public slots:
 
@@ -74,7 +68,7 @@ public slots:
     virtual void startBlinking();
 
     /**
-     * Makes the character blink.
+     * Makes the character blink, as many times as its model tells.
      */
     virtual void blink();
 };
@@ -0,0 +1,384 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "clustergraph.h"
+#include "maze.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdlib.h>
+
+const int ClusterGraph::CLUSTER_SIZE = 16;
+
+namespace
+{
+
+/** The 4 Directions enabling to go from a Cell to its neighbours */
+const Maze::Direction directions[4] = {Maze::UP, Maze::RIGHT, Maze::DOWN, Maze::LEFT};
+
+/**
+ * The scratch data of the searches : each thread keeps its own, so that several paths can be computed at the same time.
+ * The values are only up to date for the Cells and entrances whose stamp is the one of the current search.
+ */
+struct Search {
+    /** The last stamp given */
+    quint32 stamp;
+    /** For each Cell, the stamp of the last cluster search that has reached it */
+    QVector<quint32> cellStamps;
+    /** For each Cell, the distance from the Cell the cluster search started from */
+    QVector<int> cellDistances;
+    /** For each Cell, the Cell which enables to go to it */
+    QVector<int> cellParents;
+    /** The queue of the cluster searches */
+    QVector<int> queue;
+    /** For each entrance, the stamp of the last search that has reached it */
+    QVector<quint32> entranceStamps;
+    /** For each entrance, the stamp of the last search that has closed it */
+    QVector<quint32> closedStamps;
+    /** For each entrance, the cost of the path from the starting Cell */
+    QVector<int> costs;
+    /** For each entrance, the entrance which enables to go to it, -1 if it is reached from the starting Cell */
+    QVector<int> parents;
+    /** For each entrance, the stamp of the last search whose target Cell is in the cluster of the entrance */
+    QVector<quint32> targetStamps;
+    /** For each entrance, the distance to the target Cell */
+    QVector<int> targetCosts;
+    /** The open list, kept as a binary heap on the estimated cost, then the entrance */
+    QVector<QPair<int, int> > openList;
+
+    Search() : stamp(0) {}
+
+    /** Resizes the data for a Maze of the given size */
+    void init(const int p_nbCells, const int p_nbEntrances)
+    {
+        if (cellStamps.size() != p_nbCells || entranceStamps.size() != p_nbEntrances) {
+            cellStamps.fill(0, p_nbCells);
+            cellDistances.resize(p_nbCells);
+            cellParents.resize(p_nbCells);
+            entranceStamps.fill(0, p_nbEntrances);
+            closedStamps.fill(0, p_nbEntrances);
+            costs.resize(p_nbEntrances);
+            parents.resize(p_nbEntrances);
+            targetStamps.fill(0, p_nbEntrances);
+            targetCosts.resize(p_nbEntrances);
+            stamp = 0;
+        }
+    }
+
+    /** Gets a new stamp */
+    quint32 nextStamp()
+    {
+        ++stamp;
+        // When the stamp wraps, the old stamps could be mistaken for the current ones
+        if (stamp == 0) {
+            cellStamps.fill(0);
+            entranceStamps.fill(0);
+            closedStamps.fill(0);
+            targetStamps.fill(0);
+            stamp = 1;
+        }
+        return stamp;
+    }
+};
+
+}
+
+ClusterGraph::ClusterGraph() : m_maze(0), m_nbClusterColumns(0), m_stamp(0)
+{
+
+}
+
+ClusterGraph::~ClusterGraph()
+{
+
+}
+
+void ClusterGraph::build(const Maze *p_maze)
+{
+    m_maze = p_maze;
+    const int nbCells = m_maze->getNbRows() * m_maze->getNbColumns();
+    m_nbClusterColumns = (m_maze->getNbColumns() + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+    const int nbClusters = m_nbClusterColumns * ((m_maze->getNbRows() + CLUSTER_SIZE - 1) / CLUSTER_SIZE);
+
+    m_cellEntrances.fill(-1, nbCells);
+    m_entranceCells.clear();
+    m_clusterEntrances.clear();
+    m_clusterEntrances.resize(nbClusters);
+    m_edges.clear();
+    m_stamp = 0;
+    m_stamps.fill(0, nbCells);
+    m_distances.resize(nbCells);
+    m_parents.resize(nbCells);
+    for (int i = 0; i < nbClusters; ++i) {
+        updateEntrances(i);
+    }
+    for (int i = 0; i < nbClusters; ++i) {
+        updateEdges(i);
+    }
+}
+
+void ClusterGraph::update(const int p_index)
+{
+    // The changed Cell only modifies the ways inside its cluster, and the moves from or to the clusters around,
+    // the Cells leading to it through a portal being maybe far away
+    QVector<int> cells;
+    m_maze->getPreviousCells(p_index, cells);
+    for (int i = 0; i < 4; ++i) {
+        cells.append(m_maze->getNeighbourIndex(p_index, directions[i]));
+    }
+    QVector<int> clusters;
+    clusters.append(getCluster(p_index));
+    for (int i = 0; i < cells.size(); ++i) {
+        if (cells[i] != -1 && !clusters.contains(getCluster(cells[i]))) {
+            clusters.append(getCluster(cells[i]));
+        }
+    }
+    for (int i = 0; i < clusters.size(); ++i) {
+        updateEntrances(clusters[i]);
+    }
+    for (int i = 0; i < clusters.size(); ++i) {
+        updateEdges(clusters[i]);
+    }
+}
+
+QList<QPoint> ClusterGraph::findPath(const int p_fromRow, const int p_fromColumn, const int p_toRow, const int p_toColumn) const
+{
+    static thread_local Search search;
+
+    QList<QPoint> path;
+    const int start = m_maze->getCellIndex(p_fromRow, p_fromColumn);
+    const int target = m_maze->getCellIndex(p_toRow, p_toColumn);
+    if (start == target || m_maze->getCellType(start) == Cell::WALL || m_maze->getCellType(target) == Cell::WALL) {
+        return path;
+    }
+    // Through a portal, the Manhattan distance may overestimate the remaining cost : fall back to Dijkstra
+    const bool useHeuristic = !m_maze->hasPortals();
+    search.init(m_maze->getNbRows() * m_maze->getNbColumns(), m_entranceCells.size());
+    const quint32 query = search.nextStamp();
+
+    // Link the entrances of the target cluster to the target Cell, searching backward from it : only a portal may not lead back
+    const int targetCluster = getCluster(target);
+    quint32 stamp = search.nextStamp();
+    searchCluster(target, search.cellDistances, search.cellParents, search.cellStamps, stamp, search.queue, !useHeuristic);
+    for (int i = 0; i < m_clusterEntrances[targetCluster].size(); ++i) {
+        const int entrance = m_clusterEntrances[targetCluster][i];
+        if (search.cellStamps[m_entranceCells[entrance]] == stamp) {
+            search.targetStamps[entrance] = query;
+            search.targetCosts[entrance] = search.cellDistances[m_entranceCells[entrance]];
+        }
+    }
+
+    // Link the starting Cell to the entrances of its cluster, and maybe directly to the target Cell
+    int bestCost = -1;
+    int bestEntrance = -1;
+    const int startCluster = getCluster(start);
+    stamp = search.nextStamp();
+    searchCluster(start, search.cellDistances, search.cellParents, search.cellStamps, stamp, search.queue);
+    if (startCluster == targetCluster && search.cellStamps[target] == stamp) {
+        bestCost = search.cellDistances[target];
+    }
+    search.openList.clear();
+    for (int i = 0; i < m_clusterEntrances[startCluster].size(); ++i) {
+        const int entrance = m_clusterEntrances[startCluster][i];
+        const int cell = m_entranceCells[entrance];
+        if (search.cellStamps[cell] == stamp) {
+            search.entranceStamps[entrance] = query;
+            search.costs[entrance] = search.cellDistances[cell];
+            search.parents[entrance] = -1;
+            const int distance = useHeuristic ? abs(p_toRow - m_maze->getRowFromIndex(cell)) + abs(p_toColumn - m_maze->getColumnFromIndex(cell)) : 0;
+            search.openList.append(qMakePair(search.costs[entrance] + distance, entrance));
+            std::push_heap(search.openList.begin(), search.openList.end(), std::greater<QPair<int, int> >());
+        }
+    }
+
+    // While there are entrances left to explore which may lead to a shorter path
+    while (!search.openList.isEmpty()) {
+        std::pop_heap(search.openList.begin(), search.openList.end(), std::greater<QPair<int, int> >());
+        const QPair<int, int> current = search.openList.takeLast();
+        const int entrance = current.second;
+        if (search.closedStamps[entrance] == query) {
+            // This entrance has already been reached through a shorter path
+            continue;
+        }
+        if (bestCost != -1 && current.first >= bestCost) {
+            break;
+        }
+        search.closedStamps[entrance] = query;
+        if (search.targetStamps[entrance] == query && (bestCost == -1 || search.costs[entrance] + search.targetCosts[entrance] < bestCost)) {
+            bestCost = search.costs[entrance] + search.targetCosts[entrance];
+            bestEntrance = entrance;
+        }
+        const QVector<QPair<int, int> > &edges = m_edges[entrance];
+        for (int i = 0; i < edges.size(); ++i) {
+            const int next = edges[i].first;
+            if (m_entranceCells[next] == -1) {
+                continue;
+            }
+            const int cost = search.costs[entrance] + edges[i].second;
+            // If the entrance has not been reached yet or if this path to it is shorter
+            if (search.entranceStamps[next] != query || (search.closedStamps[next] != query && cost < search.costs[next])) {
+                search.entranceStamps[next] = query;
+                search.costs[next] = cost;
+                search.parents[next] = entrance;
+                const int cell = m_entranceCells[next];
+                const int distance = useHeuristic ? abs(p_toRow - m_maze->getRowFromIndex(cell)) + abs(p_toColumn - m_maze->getColumnFromIndex(cell)) : 0;
+                search.openList.append(qMakePair(cost + distance, next));
+                std::push_heap(search.openList.begin(), search.openList.end(), std::greater<QPair<int, int> >());
+            }
+        }
+    }
+    if (bestCost == -1) {
+        return path;
+    }
+
+    // List the Cells to go through : the starting Cell, the entrances, then the target Cell
+    QVector<int> waypoints;
+    waypoints.append(target);
+    for (int entrance = bestEntrance; entrance != -1; entrance = search.parents[entrance]) {
+        if (m_entranceCells[entrance] != waypoints.last()) {
+            waypoints.append(m_entranceCells[entrance]);
+        }
+    }
+    if (waypoints.last() != start) {
+        waypoints.append(start);
+    }
+    std::reverse(waypoints.begin(), waypoints.end());
+    // Refine the path : the moves between two clusters are direct, the ways inside a cluster are searched again
+    for (int i = 1; i < waypoints.size(); ++i) {
+        if (getCluster(waypoints[i - 1]) != getCluster(waypoints[i])) {
+            path.append(m_maze->getCoords(waypoints[i]));
+            continue;
+        }
+        stamp = search.nextStamp();
+        searchCluster(waypoints[i - 1], search.cellDistances, search.cellParents, search.cellStamps, stamp, search.queue);
+        const int position = path.size();
+        for (int cell = waypoints[i]; cell != waypoints[i - 1]; cell = search.cellParents[cell]) {
+            path.insert(position, m_maze->getCoords(cell));
+        }
+    }
+
+    return path;
+}
+
+int ClusterGraph::getCluster(const int p_index) const
+{
+    return (m_maze->getRowFromIndex(p_index) / CLUSTER_SIZE) * m_nbClusterColumns + m_maze->getColumnFromIndex(p_index) / CLUSTER_SIZE;
+}
+
+void ClusterGraph::updateEntrances(const int p_cluster)
+{
+    const int firstRow = (p_cluster / m_nbClusterColumns) * CLUSTER_SIZE;
+    const int firstColumn = (p_cluster % m_nbClusterColumns) * CLUSTER_SIZE;
+    const int lastRow = qMin(firstRow + CLUSTER_SIZE, m_maze->getNbRows());
+    const int lastColumn = qMin(firstColumn + CLUSTER_SIZE, m_maze->getNbColumns());
+
+    // The entrances are the Cells which can move to another cluster
+    QVector<int> &entrances = m_clusterEntrances[p_cluster];
+    entrances.clear();
+    for (int row = firstRow; row < lastRow; ++row) {
+        for (int column = firstColumn; column < lastColumn; ++column) {
+            const int cell = m_maze->getCellIndex(row, column);
+            bool isEntrance = false;
+            for (int i = 0; i < 4 && !isEntrance && m_maze->getCellType(cell) != Cell::WALL; ++i) {
+                const int next = m_maze->getNeighbourIndex(cell, directions[i]);
+                isEntrance = next != -1 && m_maze->getCellType(next) != Cell::WALL && getCluster(next) != p_cluster;
+            }
+            if (isEntrance) {
+                if (m_cellEntrances[cell] == -1) {
+                    m_cellEntrances[cell] = m_entranceCells.size();
+                    m_entranceCells.append(cell);
+                    m_edges.append(QVector<QPair<int, int> >());
+                }
+                entrances.append(m_cellEntrances[cell]);
+            } else if (m_cellEntrances[cell] != -1) {
+                // The entrance number is kept unused, so that the other entrances keep theirs
+                m_entranceCells[m_cellEntrances[cell]] = -1;
+                m_edges[m_cellEntrances[cell]].clear();
+                m_cellEntrances[cell] = -1;
+            }
+        }
+    }
+}
+
+void ClusterGraph::updateEdges(const int p_cluster)
+{
+    const QVector<int> &entrances = m_clusterEntrances[p_cluster];
+
+    // Link each entrance to the entrances of the other clusters it leads to, and to the ones of its cluster it can reach
+    for (int i = 0; i < entrances.size(); ++i) {
+        const int cell = m_entranceCells[entrances[i]];
+        QVector<QPair<int, int> > &edges = m_edges[entrances[i]];
+        edges.clear();
+        for (int j = 0; j < 4; ++j) {
+            const int next = m_maze->getNeighbourIndex(cell, directions[j]);
+            if (next != -1 && m_maze->getCellType(next) != Cell::WALL && getCluster(next) != p_cluster && m_cellEntrances[next] != -1) {
+                edges.append(qMakePair(m_cellEntrances[next], 1));
+            }
+        }
+        // When the stamp wraps, the old stamps could be mistaken for the current ones
+        if (++m_stamp == 0) {
+            m_stamps.fill(0);
+            m_stamp = 1;
+        }
+        searchCluster(cell, m_distances, m_parents, m_stamps, m_stamp, m_queue);
+        for (int j = 0; j < entrances.size(); ++j) {
+            const int other = m_entranceCells[entrances[j]];
+            if (other != cell && m_stamps[other] == m_stamp) {
+                edges.append(qMakePair(entrances[j], m_distances[other]));
+            }
+        }
+    }
+}
+
+void ClusterGraph::searchCluster(const int p_index, QVector<int> &p_distances, QVector<int> &p_parents,
+                                 QVector<quint32> &p_stamps, const quint32 p_stamp, QVector<int> &p_queue, const bool p_isBackward) const
+{
+    // The Cells leading to a Cell, when searching backward
+    static thread_local QVector<int> previousCells;
+    const int cluster = getCluster(p_index);
+
+    p_queue.clear();
+    p_stamps[p_index] = p_stamp;
+    p_distances[p_index] = 0;
+    p_parents[p_index] = -1;
+    p_queue.append(p_index);
+    for (int i = 0; i < p_queue.size(); ++i) {
+        const int current = p_queue[i];
+        int neighbours[4];
+        const int *nextCells = neighbours;
+        int nbNextCells = 4;
+        if (p_isBackward) {
+            m_maze->getPreviousCells(current, previousCells);
+            nextCells = previousCells.constData();
+            nbNextCells = previousCells.size();
+        } else {
+            for (int j = 0; j < 4; ++j) {
+                neighbours[j] = m_maze->getNeighbourIndex(current, directions[j]);
+            }
+        }
+        for (int j = 0; j < nbNextCells; ++j) {
+            const int next = nextCells[j];
+            if (next == -1 || p_stamps[next] == p_stamp || m_maze->getCellType(next) == Cell::WALL || getCluster(next) != cluster) {
+                continue;
+            }
+            p_stamps[next] = p_stamp;
+            p_distances[next] = p_distances[current] + 1;
+            p_parents[next] = current;
+            p_queue.append(next);
+        }
+    }
+}
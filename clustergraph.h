@@ -0,0 +1,154 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLUSTERGRAPH_H
+#define CLUSTERGRAPH_H
+
+#include <QList>
+#include <QPair>
+#include <QPoint>
+#include <QVector>
+
+class Maze;
+
+/**
+ * @brief This class computes paths between two Cells of a large Maze with the hierarchical A* algorithm (HPA*).
+ *
+ * The Maze is split into square clusters of Cells. The entrances are the Cells linked to a Cell of another cluster,
+ * and the abstract graph links each entrance to the entrances of the other clusters it leads to and to the entrances
+ * of its own cluster, with the length of the shortest way inside the cluster.
+ * A path is searched on the abstract graph, then refined into Cells one cluster at a time.
+ * The paths found are nearly, but not always, the shortest ones.
+ *
+ * The abstract graph is not modified by the searches, so several paths can be computed at the same time.
+ */
+class ClusterGraph
+{
+
+public:
+
+    /** The number of Cells on each side of a cluster */
+    static const int CLUSTER_SIZE;
+
+private:
+
+    /** The Maze the graph has been built from */
+    const Maze *m_maze;
+
+    /** The number of clusters on each row of clusters */
+    int m_nbClusterColumns;
+
+    /** For each Cell, its entrance number, -1 if the Cell is not an entrance */
+    QVector<int> m_cellEntrances;
+
+    /** For each entrance, the index of its Cell, -1 if the entrance is no longer used */
+    QVector<int> m_entranceCells;
+
+    /** For each cluster, its entrances */
+    QVector<QVector<int> > m_clusterEntrances;
+
+    /** For each entrance, the entrances it leads to and the length of the way to each of them */
+    QVector<QVector<QPair<int, int> > > m_edges;
+
+    /** The last stamp given to a search run while building the graph */
+    quint32 m_stamp;
+
+    /** For each Cell, the stamp of the last search run while building the graph that has reached it */
+    QVector<quint32> m_stamps;
+
+    /** For each Cell, the distance from the Cell the search run while building the graph started from */
+    QVector<int> m_distances;
+
+    /** For each Cell, the Cell which enables to go to it */
+    QVector<int> m_parents;
+
+    /** The queue of the searches run while building the graph */
+    QVector<int> m_queue;
+
+public:
+
+    /**
+     * Creates a new ClusterGraph instance.
+     */
+    ClusterGraph();
+
+    /**
+     * Deletes the ClusterGraph instance.
+     */
+    ~ClusterGraph();
+
+    /**
+     * Builds the abstract graph of the given Maze, whose Cells and neighbours must have been computed.
+     * @param p_maze the Maze
+     */
+    void build(const Maze *p_maze);
+
+    /**
+     * Updates the abstract graph once a Cell has been opened or closed : only the clusters around the Cell are computed again.
+     * @param p_index the index of the changed Cell
+     */
+    void update(const int p_index);
+
+    /**
+     * Gets a short path between two Cells of the Maze.
+     * @param p_fromRow the row index of the starting Cell
+     * @param p_fromColumn the column index of the starting Cell
+     * @param p_toRow the row index of the target Cell
+     * @param p_toColumn the column index of the target Cell
+     * @return the Cell coordinates to go through, the starting Cell excluded and the target Cell included,
+     * or an empty list if the target Cell cannot be reached
+     */
+    QList<QPoint> findPath(const int p_fromRow, const int p_fromColumn, const int p_toRow, const int p_toColumn) const;
+
+private:
+
+    /**
+     * Gets the cluster of a Cell.
+     * @param p_index the Cell index
+     * @return the cluster number
+     */
+    int getCluster(const int p_index) const;
+
+    /**
+     * Computes again the entrances of a cluster.
+     * @param p_cluster the cluster number
+     */
+    void updateEntrances(const int p_cluster);
+
+    /**
+     * Computes again the edges leaving the entrances of a cluster, once the entrances of all the clusters are known.
+     * @param p_cluster the cluster number
+     */
+    void updateEdges(const int p_cluster);
+
+    /**
+     * Computes the distances from a Cell to the other Cells of its cluster, without leaving the cluster,
+     * or from the other Cells to it, the moves through a portal not always leading back.
+     * @param p_index the Cell index
+     * @param p_distances for each Cell, the distance from or to the given Cell, only valid for the reached Cells
+     * @param p_parents for each Cell, the Cell which enables to go to it, or the one it leads to when searching backward
+     * @param p_stamps for each Cell, the stamp of the last search that has reached it
+     * @param p_stamp the stamp of this search
+     * @param p_queue the queue of the Cells to explore
+     * @param p_isBackward true to compute the distances to the given Cell, false to compute the distances from it
+     */
+    void searchCluster(const int p_index, QVector<int> &p_distances, QVector<int> &p_parents,
+                       QVector<quint32> &p_stamps, const quint32 p_stamp, QVector<int> &p_queue, const bool p_isBackward = false) const;
+};
+
+#endif
+
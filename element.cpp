@@ -27,11 +27,6 @@ Element::~Element()
 {
 }
 
-void Element::doActionOnCollision(Kapman *)
-{
-    // Do nothing by default : will be redefined within the subclasses
-}
-
 qreal Element::getX() const
 {
     return m_x;
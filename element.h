@@ -22,8 +22,6 @@
 
 #include "maze.h"
 
-class Kapman;
-
 /**
  * @brief This class describes the common characteristics and behaviour of any game Element (character or item).
  */
@@ -84,12 +82,6 @@ public:
      */
     ~Element();
 
-    /**
-     * Computes an action on a collision with the Kapman.
-     * @param p_kapman the instance of Kapman which collides with the Element
-     */
-    virtual void doActionOnCollision(Kapman *p_kapman);
-
     /**
      * Gets the path to the Element image.
      * @return the path to the Element image
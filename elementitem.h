@@ -58,11 +58,6 @@ public:
      */
     Element *getModel() const;
 
-    /**
-     * Reimplement QGraphicsItem::shape() to return an ellipse to improve collisions.
-     */
-    QPainterPath shape() const Q_DECL_OVERRIDE;
-
 public slots:
 
     /**
@@ -22,19 +22,64 @@
 #include "settings.h"
 
 #include <KgDifficulty>
+#include <QGuiApplication>
+#include <QScreen>
 #include <QStandardPaths>
 
-const int Game::FPS = 40;
-int Game::s_bonusDuration;
-int Game::s_preyStateDuration;
-qreal Game::s_durationRatio;
+const int Game::MAX_TICKS_PER_FRAME = 8;
+const int Game::DEATH_DURATION = 2500;
+const int Game::POINTS_DURATION = 1000;
+const int Game::KAPMAN_BLINK_DURATION = 400;
+const int Game::KAPMAN_NB_BLINKS = 4;
+const int Game::GHOST_BLINK_PARTS = 20;
+const int Game::GHOST_START_BLINKING_PART = 15;
 
-Game::Game() :
+namespace
+{
+/**
+ * Gets the game difficulty from the KgDifficulty singleton.
+ * @return the difficulty of the new games
+ */
+GameState::Difficulty currentDifficulty()
+{
+    switch (Kg::difficultyLevel()) {
+    case KgDifficultyLevel::Easy:
+        return GameState::EASY;
+    case KgDifficultyLevel::Hard:
+        return GameState::HARD;
+    default:
+        return GameState::MEDIUM;
+    }
+}
+
+/**
+ * Reads the XML description of the default Maze.
+ * @return the content of the Maze file
+ */
+QByteArray defaultMaze()
+{
+    QFile mazeXmlFile(QStandardPaths::locate(QStandardPaths::AppDataLocation, QLatin1Literal("defaultmaze.xml")));
+    mazeXmlFile.open(QIODevice::ReadOnly);
+    return mazeXmlFile.readAll();
+}
+}
+
+Game::Game(const quint64 p_seed) : Game(new Recording(p_seed, currentDifficulty(), defaultMaze()), false)
+{
+}
+
+Game::Game(Recording *p_replay) : Game(p_replay, true)
+{
+}
+
+Game::Game(Recording *p_recording, const bool p_isReplay) :
+    m_simulatedTime(0),
+    m_turboTicks(0),
+    m_simulation(NULL),
+    m_input(Maze::NONE),
+    m_recording(p_recording),
+    m_isReplay(p_isReplay),
     m_isCheater(false),
-    m_lives(3),
-    m_points(0),
-    m_level(1),
-    m_nbEatenGhosts(0),
     m_soundGameOver(QStandardPaths::locate(QStandardPaths::GenericDataLocation, QLatin1String("sounds/kapman/gameover.ogg"))),
     m_soundGhost(QStandardPaths::locate(QStandardPaths::GenericDataLocation, QLatin1String("sounds/kapman/ghost.ogg"))),
     m_soundGainLife(QStandardPaths::locate(QStandardPaths::GenericDataLocation, QLatin1String("sounds/kapman/life.ogg"))),
@@ -46,74 +91,48 @@ Game::Game() :
     // Initialize the sound state
     setSoundsEnabled(Settings::sounds());
 
-    // Timers for medium difficulty
-    s_bonusDuration = 7000;
-    s_preyStateDuration = 10000;
-    // Difference ratio between low/high and medium speed
-    s_durationRatio = 1.0;
-
     // Tells the KgDifficulty singleton that the game is not running
     Kg::difficulty()->setGameRunning(false);
 
     // Create the Maze instance
     m_maze = new Maze();
-    connect(m_maze, &Maze::allElementsEaten, this, &Game::nextLevel);
 
-    // Create the parser that will parse the XML file in order to initialize the Maze instance
-    // This also creates all the characters
-    KapmanParser kapmanParser(this);
-    // Set the XML file as input source for the parser
-    QFile mazeXmlFile(QStandardPaths::locate(QStandardPaths::AppDataLocation, QLatin1Literal("defaultmaze.xml")));
-    QXmlInputSource source(&mazeXmlFile);
+    // Create the game state with the recorded seed and difficulty level
+    m_gameState = new GameState(m_maze, m_recording->getDifficulty(), m_recording->getSeed());
+
+    // Create the parser that will parse the XML file in order to initialize the Maze instance and the game state
+    KapmanParser kapmanParser(m_maze, m_gameState);
+    // Set the recorded Maze as input source for the parser
+    QXmlInputSource source;
+    source.setData(m_recording->getMaze());
     // Create the XML file reader
     QXmlSimpleReader reader;
     reader.setContentHandler(&kapmanParser);
     // Parse the XML file
     reader.parse(source);
 
-    connect(m_kapman, &Kapman::sWinPoints, this, &Game::winPoints);
-
-    // Initialize the characters speed timers duration considering the difficulty level
-    switch (Kg::difficultyLevel()) {
-    case KgDifficultyLevel::Easy:
-        // Ratio low/medium speed
-        s_durationRatio = Character::MEDIUM_SPEED / Character::LOW_SPEED;
-        break;
-    case KgDifficultyLevel::Medium:
-        s_durationRatio = 1;
-        break;
-    case KgDifficultyLevel::Hard:
-        // Ratio high/medium speed
-        s_durationRatio = Character::MEDIUM_SPEED / Character::HIGH_SPEED;
-        break;
-    default:
-        break;
+    // Create the characters the game state has been given : the Pills & Energizers are only bytes of the Maze
+    m_kapman = new Kapman(Cell::toPixels(m_gameState->getKapman().xInit), Cell::toPixels(m_gameState->getKapman().yInit), m_maze);
+    for (int i = 0; i < m_gameState->getNbGhosts(); ++i) {
+        const GameState::GhostData ghost = m_gameState->getGhost(i);
+        m_ghosts.append(new Ghost(Cell::toPixels(ghost.xInit), Cell::toPixels(ghost.yInit), kapmanParser.getGhostImageIds().at(i), m_maze));
     }
-
-    for (int i = 0; i < m_ghosts.size(); ++i) {
-        connect(m_ghosts[i], SIGNAL(lifeLost()), this, SLOT(kapmanDeath()));
-        connect(m_ghosts[i], SIGNAL(ghostEaten(Ghost*)), this, SLOT(ghostDeath(Ghost*)));
-        // Initialize the ghosts speed and the ghost speed increase considering the characters speed
-        m_ghosts[i]->initSpeedInc();
-    }
-    m_kapman->initSpeedInc();
-
-    // Initialize Bonus timer from the difficulty level
-    m_bonusTimer = new QTimer(this);
-    m_bonusTimer->setInterval((int)(s_bonusDuration * s_durationRatio));
-    m_bonusTimer->setSingleShot(true);
-    connect(m_bonusTimer, &QTimer::timeout, this, &Game::hideBonus);
-    // Initialize the Preys timer from the difficulty level
-    m_preyTimer = new QTimer(this);
-    m_preyTimer->setInterval((int)(s_preyStateDuration * s_durationRatio));
-    m_preyTimer->setSingleShot(true);
-    connect(m_preyTimer, &QTimer::timeout, this, &Game::endPreyState);
-
-    // Start the Game timer
+    m_bonus = new Bonus(Cell::toPixels(m_gameState->getBonusX()), Cell::toPixels(m_gameState->getBonusY()), m_maze, 100);
+    m_frame.kapman = Character::NO_CHANGE;
+    m_frame.ghosts.fill(Character::NO_CHANGE, m_ghosts.size());
+    m_frame.scoreChanged = false;
+
+    // Start the Game timer at the screen refresh rate : the ticks are run at their own rate against the clock
+    qreal refreshRate = 60;
+    if (QGuiApplication::primaryScreen() != NULL) {
+        refreshRate = QGuiApplication::primaryScreen()->refreshRate();
+    }
+    m_frameInterval = qMax(1, int(1000 / refreshRate));
     m_timer = new QTimer(this);
-    m_timer->setInterval(int(1000 / Game::FPS));
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->setInterval(m_frameInterval);
     connect(m_timer, &QTimer::timeout, this, &Game::update);
-    m_timer->start();
+    startLoop();
     m_state = RUNNING;
     // Init the characters coordinates on the Maze
     initCharactersPosition();
@@ -121,8 +140,11 @@ Game::Game() :
 
 Game::~Game()
 {
+    // Stop the simulation thread before deleting what it uses
+    delete m_simulation;
     delete m_timer;
-    delete m_bonusTimer;
+    delete m_gameState;
+    delete m_recording;
     delete m_maze;
     delete m_kapman;
     for (int i = 0; i < m_ghosts.size(); ++i) {
@@ -134,15 +156,20 @@ Game::~Game()
 void Game::start()
 {
     // Restart the Game timer
-    m_timer->start();
-    m_state = RUNNING;
-    emit(pauseChanged(false, false));
+    startLoop();
+    // The pause while the Kapman is dying goes on until its timeout expires
+    if (isKapmanDying()) {
+        m_state = PAUSED_LOCKED;
+    } else {
+        m_state = RUNNING;
+        emit(pauseChanged(false, false));
+    }
 }
 
 void Game::pause(bool p_locked)
 {
     // Stop the Game timer
-    m_timer->stop();
+    stopLoop();
     if (p_locked) {
         m_state = PAUSED_LOCKED;
     } else {
@@ -153,6 +180,15 @@ void Game::pause(bool p_locked)
 
 void Game::switchPause(bool p_locked)
 {
+    // The player cannot resume a locked pause
+    if (m_state == PAUSED_LOCKED) {
+        return;
+    }
+    // The simulation thread records the inputs while it runs
+    stopLoop();
+    if (!m_isReplay) {
+        m_recording->addInput(m_gameState->getTick(), Recording::PAUSE);
+    }
     // If the Game is not already paused
     if (m_state == RUNNING) {
         // Pause the Game
@@ -192,6 +228,54 @@ bool Game::isPaused() const
     return (m_state != RUNNING);
 }
 
+void Game::setTurbo(const int p_ticksPerFrame)
+{
+    const bool isActive = m_timer->isActive();
+
+    // The simulation thread, if any, takes the new rate once started again
+    stopLoop();
+    m_turboTicks = qMax(0, p_ticksPerFrame);
+    // In turbo mode, a new frame is started as soon as the event loop has drawn the last one
+    m_timer->setInterval(m_turboTicks > 0 ? 0 : m_frameInterval);
+    m_clock.start();
+    m_simulatedTime = 0;
+    if (isActive) {
+        startLoop();
+    }
+}
+
+void Game::setThreaded(const bool p_isThreaded)
+{
+    const bool isActive = m_timer->isActive();
+
+    stopLoop();
+    delete m_simulation;
+    m_simulation = p_isThreaded ? new SimulationThread(m_recording, m_isReplay) : NULL;
+    if (isActive) {
+        startLoop();
+    }
+}
+
+quint64 Game::getSeed() const
+{
+    return m_gameState->getSeed();
+}
+
+const Recording *Game::getRecording() const
+{
+    return m_recording;
+}
+
+bool Game::isReplay() const
+{
+    return m_isReplay;
+}
+
+int Game::getTick() const
+{
+    return m_gameState->getTick();
+}
+
 bool Game::isCheater() const
 {
     return m_isCheater;
@@ -199,40 +283,32 @@ bool Game::isCheater() const
 
 int Game::getScore() const
 {
-    return m_points;
+    return m_gameState->getScore();
 }
 int Game::getLives() const
 {
-    return m_lives;
+    return m_gameState->getLives();
 }
 
 int Game::getLevel() const
 {
-    return m_level;
+    return m_gameState->getLevel();
 }
 
 void Game::setLevel(int p_level)
 {
+    if (m_isReplay) {
+        return;
+    }
+    stopLoop();
+    m_recording->addInput(m_gameState->getTick(), Recording::SET_LEVEL, p_level);
     m_isCheater = true;
-    m_level = p_level;
-    m_maze->resetNbElem();
-    m_timer->start();   // Needed to reinit character positions
+    m_gameState->setLevel(p_level);
     initCharactersPosition();
-    for (int i = 0; i < m_ghosts.size(); ++i) {
-        m_ghosts[i]->initSpeed();
-    }
-    m_kapman->initSpeed();
-    for (int i = 0; i < m_level; ++i) {
-        for (int j = 0; j < m_ghosts.size(); ++j) {
-            m_ghosts[j]->increaseCharactersSpeed();
-        }
-        m_kapman->increaseCharactersSpeed();
-    }
-    setTimersDuration();
-    m_bonus->setPoints(m_level * 100);
-    emit(scoreChanged(m_points));
-    emit(livesChanged(m_lives));
-    emit(levelChanged(m_level));
+    m_bonus->setPoints(m_gameState->getBonusPoints());
+    emit(scoreChanged(getScore()));
+    emit(livesChanged(getLives()));
+    emit(levelChanged(getLevel()));
     emit(pauseChanged(false, true));
     emit(levelStarted(true));
 }
@@ -242,71 +318,155 @@ Bonus *Game::getBonus() const
     return m_bonus;
 }
 
-void Game::createBonus(QPointF p_position)
+void Game::setSoundsEnabled(bool p_enabled)
 {
-    m_bonus = new Bonus(qreal(Cell::SIZE * p_position.x()), qreal(Cell::SIZE * p_position.y()), m_maze, 100);
+    m_soundEnabled = p_enabled;
+    Settings::setSounds(p_enabled);
+    Settings::self()->save();
 }
 
-void Game::createKapman(QPointF p_position)
+void Game::initCharactersPosition()
 {
-    m_kapman = new Kapman(qreal(Cell::SIZE * p_position.x()), qreal(Cell::SIZE * p_position.y()), m_maze);
+    // At the beginning, the timer is stopped but the Game isn't paused (to allow keyPressedEvent detection)
+    stopLoop();
+    m_state = RUNNING;
+    m_input = Maze::NONE;
+    // Initialize the characters coordinates and the Ghosts state
+    m_gameState->initCharacters();
+    clearTimeouts();
+    m_frame.kapman |= m_kapman->init(m_gameState->getKapman());
+    for (int i = 0; i < m_ghosts.size(); ++i) {
+        const GameState::GhostData ghost = m_gameState->getGhost(i);
+        m_frame.ghosts[i] |= m_ghosts[i]->update(ghost);
+        m_frame.ghosts[i] |= m_ghosts[i]->updatePosition(ghost, 1.0);
+    }
+    // Show the characters at once, as the Game timer is stopped until a key is pressed
+    publishFrame();
 }
 
-void Game::createGhost(QPointF p_position, const QString &p_imageId)
+void Game::updateCharacters()
 {
-    m_ghosts.append(new Ghost(qreal(Cell::SIZE * p_position.x()), qreal(Cell::SIZE * p_position.y()), p_imageId, m_maze));
+    // The Ghosts blink once per part of the prey state, from a given part to the end of the state
+    const int preyTicks = m_gameState->getPreyTicks();
+    const int preyDuration = qMax(1, m_gameState->getPreyDuration());
+    const int preyPart = preyTicks > 0 ? (preyDuration - preyTicks) * GHOST_BLINK_PARTS / preyDuration : 0;
+    const int nbBlinks = qMax(0, preyPart - GHOST_START_BLINKING_PART);
+
+    m_frame.kapman |= m_kapman->update(m_gameState->getKapman());
+    for (int i = 0; i < m_ghosts.size(); ++i) {
+        m_frame.ghosts[i] |= m_ghosts[i]->update(m_gameState->getGhost(i));
+        m_frame.ghosts[i] |= m_ghosts[i]->setNbBlinks(nbBlinks);
+    }
 }
 
-void Game::initMaze(const int p_nbRows, const int p_nbColumns)
+void Game::updatePositions(const qreal p_alpha)
 {
-    m_maze->init(p_nbRows, p_nbColumns);
+    m_frame.kapman |= m_kapman->updatePosition(m_gameState->getKapman(), p_alpha);
+    for (int i = 0; i < m_ghosts.size(); ++i) {
+        m_frame.ghosts[i] |= m_ghosts[i]->updatePosition(m_gameState->getGhost(i), p_alpha);
+    }
 }
 
-void Game::setSoundsEnabled(bool p_enabled)
+void Game::publishFrame()
 {
-    m_soundEnabled = p_enabled;
-    Settings::setSounds(p_enabled);
-    Settings::self()->save();
+    if (m_frame.scoreChanged) {
+        emit(scoreChanged(getScore()));
+    }
+    emit(frameUpdated(m_frame));
+    m_frame.kapman = Character::NO_CHANGE;
+    m_frame.ghosts.fill(Character::NO_CHANGE);
+    m_frame.eatenCells.clear();
+    m_frame.wonPoints.clear();
+    m_frame.scoreChanged = false;
 }
 
-void Game::initCharactersPosition()
+void Game::handleEvents()
 {
-    // If the timer is stopped, it means that collisions are already being handled
-    if (m_timer->isActive()) {
-        // At the beginning, the timer is stopped but the Game isn't paused (to allow keyPressedEvent detection)
-        m_timer->stop();
-        m_state = RUNNING;
-        // Initialize Ghost coordinates and state
-        m_ghosts[0]->initCoordinate();
-        m_ghosts[1]->initCoordinate();
-        m_ghosts[2]->initCoordinate();
-        m_ghosts[3]->initCoordinate();
-        m_kapman->initCoordinate();
-        m_ghosts[0]->setState(Ghost::HUNTER);
-        m_ghosts[1]->setState(Ghost::HUNTER);
-        m_ghosts[2]->setState(Ghost::HUNTER);
-        m_ghosts[3]->setState(Ghost::HUNTER);
-        m_kapman->init();
-        // Initialize the Pills & Energizers coordinates
-        for (int i = 0; i < m_maze->getNbRows(); ++i) {
-            for (int j = 0; j < m_maze->getNbColumns(); ++j) {
-                if (m_maze->getCell(i, j).getElement() != NULL) {
-                    m_maze->getCell(i, j).getElement()->setX(Cell::SIZE * (j + 0.5));
-                    m_maze->getCell(i, j).getElement()->setY(Cell::SIZE * (i + 0.5));
-                }
-            }
+    const QVector<GameState::Event> &events = m_gameState->getEvents();
+
+    for (int i = 0; i < events.size(); ++i) {
+        handleEvent(events[i]);
+    }
+}
+
+void Game::handleEvent(const GameState::Event &p_event)
+{
+    WonPoints wonPoints;
+
+    m_frame.scoreChanged = m_frame.scoreChanged || p_event.points != 0;
+    switch (p_event.type) {
+    case GameState::PILL_EATEN:
+        if (m_soundEnabled) {
+            m_soundPill.start();
         }
+        m_frame.eatenCells.append(p_event.index);
+        break;
+    case GameState::ENERGIZER_EATEN:
+        if (m_soundEnabled) {
+            m_soundEnergizer.start();
+        }
+        m_frame.eatenCells.append(p_event.index);
+        break;
+    case GameState::GHOST_EATEN:
+        if (m_soundEnabled) {
+            m_soundGhost.start();
+        }
+        // Give the scene the number of points to display and its position
+        wonPoints.points = p_event.points;
+        wonPoints.x = Cell::toPixels(m_gameState->getGhost(p_event.index).x);
+        wonPoints.y = Cell::toPixels(m_gameState->getGhost(p_event.index).y);
+        m_frame.wonPoints.append(wonPoints);
+        m_timeouts.add(POINTS_TIMEOUT, POINTS_DURATION * GameState::TICKS_PER_SECOND / 1000);
+        break;
+    case GameState::BONUS_EATEN:
+        if (m_soundEnabled) {
+            m_soundBonus.start();
+        }
+        wonPoints.points = p_event.points;
+        wonPoints.x = m_bonus->getX();
+        wonPoints.y = m_bonus->getY();
+        m_frame.wonPoints.append(wonPoints);
+        m_timeouts.add(POINTS_TIMEOUT, POINTS_DURATION * GameState::TICKS_PER_SECOND / 1000);
+        emit(bonusOff());
+        break;
+    case GameState::BONUS_ON:
+        emit(bonusOn());
+        break;
+    case GameState::BONUS_OFF:
+        emit(bonusOff());
+        break;
+    case GameState::LIFE_WON:
+        if (m_soundEnabled) {
+            m_soundGainLife.start();
+        }
+        emit(livesChanged(getLives()));
+        break;
+    case GameState::KAPMAN_DEATH:
+        kapmanDeath();
+        break;
+    case GameState::LEVEL_COMPLETED:
+        startNextLevel();
+        break;
     }
 }
 
-void Game::setTimersDuration()
+void Game::startNextLevel()
 {
-    // Updates the timers duration ratio with the ghosts speed
-    s_durationRatio = Character::MEDIUM_SPEED / m_ghosts[0]->getNormalSpeed();
+    if (m_soundEnabled) {
+        m_soundLevelUp.start();
+    }
 
-    // Updates the timers duration
-    m_bonusTimer->setInterval((int)(s_bonusDuration * s_durationRatio));
-    m_preyTimer->setInterval((int)(s_preyStateDuration * s_durationRatio));
+    // Update Bonus
+    m_bonus->setPoints(m_gameState->getBonusPoints());
+    emit(bonusOff());
+    // Move all characters to their initial positions
+    initCharactersPosition();
+    // Update the score, level and lives labels
+    emit(scoreChanged(getScore()));
+    emit(livesChanged(getLives()));
+    emit(levelChanged(getLevel()));
+    // Update the view
+    emit(levelStarted(true));
 }
 
 void Game::keyPressEvent(QKeyEvent *p_event)
@@ -318,7 +478,7 @@ void Game::keyPressEvent(QKeyEvent *p_event)
             switchPause();
         } else if (m_state == RUNNING) {    // At the game beginning
             // Start the game
-            m_timer->start();
+            startLoop();
             emit(gameStarted());
         }
         // Tells the KgDifficulty singleton that the game now runs
@@ -327,23 +487,23 @@ void Game::keyPressEvent(QKeyEvent *p_event)
     // Behaviour when the game has begun
     switch (p_event->key()) {
     case Qt::Key_Up:
-        if (m_state == RUNNING) {
-            m_kapman->goUp();
+        if (m_state == RUNNING && !m_isReplay) {
+            setInput(Maze::UP);
         }
         break;
     case Qt::Key_Down:
-        if (m_state == RUNNING) {
-            m_kapman->goDown();
+        if (m_state == RUNNING && !m_isReplay) {
+            setInput(Maze::DOWN);
         }
         break;
     case Qt::Key_Right:
-        if (m_state == RUNNING) {
-            m_kapman->goRight();
+        if (m_state == RUNNING && !m_isReplay) {
+            setInput(Maze::RIGHT);
         }
         break;
     case Qt::Key_Left:
-        if (m_state == RUNNING) {
-            m_kapman->goLeft();
+        if (m_state == RUNNING && !m_isReplay) {
+            setInput(Maze::LEFT);
         }
         break;
     case Qt::Key_P:
@@ -352,17 +512,14 @@ void Game::keyPressEvent(QKeyEvent *p_event)
         break;
     case Qt::Key_K:
         // Cheat code to get one more life
-        if (p_event->modifiers() == (Qt::AltModifier | Qt::ControlModifier | Qt::ShiftModifier)) {
-            m_lives++;
-            m_isCheater = true;
-            emit(livesChanged(m_lives));
+        if (p_event->modifiers() == (Qt::AltModifier | Qt::ControlModifier | Qt::ShiftModifier) && m_state == RUNNING && !m_isReplay) {
+            addInput(Recording::ADD_LIFE);
         }
         break;
     case Qt::Key_L:
         // Cheat code to go to the next level
-        if (p_event->modifiers() == (Qt::AltModifier | Qt::ControlModifier | Qt::ShiftModifier)) {
-            m_isCheater = true;
-            nextLevel();
+        if (p_event->modifiers() == (Qt::AltModifier | Qt::ControlModifier | Qt::ShiftModifier) && m_state == RUNNING && !m_isReplay) {
+            addInput(Recording::NEXT_LEVEL);
         }
         break;
     default:
@@ -370,185 +527,334 @@ void Game::keyPressEvent(QKeyEvent *p_event)
     }
 }
 
-void Game::update()
+void Game::startLoop()
 {
-    int curKapmanRow, curKapmanCol;
-
-    // Check if the kapman is in the line of sight of a ghost
-    curKapmanRow = m_maze->getRowFromY(m_kapman->getY());
-    curKapmanCol = m_maze->getColFromX(m_kapman->getX());
+    // The simulation thread, if any, is started by the first frame
+    m_timer->start();
+    m_clock.start();
+    m_simulatedTime = 0;
+}
 
-    for (int i = 0; i < m_ghosts.size(); ++i) {
-        if (m_ghosts[i]->getState() == Ghost::HUNTER && m_ghosts[i]->isInLineSight(m_kapman)) {
-            m_ghosts[i]->updateMove(curKapmanRow, curKapmanCol);
-        } else {
-            m_ghosts[i]->updateMove();
+void Game::stopLoop()
+{
+    m_timer->stop();
+    if (m_simulation != NULL && m_simulation->isStarted()) {
+        m_simulation->stop();
+        // Go on from the last tick the thread has run
+        const SimulationThread::Frame *frame = m_simulation->takeFrame(getTick());
+        if (frame != NULL) {
+            applySimulationFrame(*frame);
         }
+        playLeftInputs();
     }
-    m_kapman->updateMove();
-    m_kapman->emitGameUpdated();
 }
 
-void Game::kapmanDeath()
+void Game::setInput(const Maze::Direction p_input)
 {
-    if (m_soundEnabled) {
-        m_soundGameOver.start();
-    }
-
-    m_lives--;
-    m_kapman->die();
-    // Make a 2 seconds pause while the kapman is blinking
-    pause(true);
-    QTimer::singleShot(2500, this, SLOT(resumeAfterKapmanDeath()));
+    addInput(Recording::getDirectionInput(p_input));
 }
 
-void Game::resumeAfterKapmanDeath()
+void Game::addInput(const Recording::Input p_input)
 {
-    emit(livesChanged(m_lives));
-    // Start the timer
-    start();
-    // Remove a possible bonus
-    emit(bonusOff());
-    // If their is no lives left, we start a new game
-    if (m_lives <= 0) {
-        emit(gameOver(true));
-    } else {
-        emit(levelStarted(false));
-        // Move all characters to their initial positions
-        initCharactersPosition();
+    // The simulation thread plays the input before its next tick
+    if (m_simulation != NULL && m_simulation->isStarted()) {
+        m_simulation->addInput(p_input);
+        return;
+    }
+    switch (p_input) {
+    case Recording::ADD_LIFE:
+        m_isCheater = true;
+        m_recording->addInput(m_gameState->getTick(), Recording::ADD_LIFE);
+        m_gameState->addLife();
+        emit(livesChanged(getLives()));
+        break;
+    case Recording::NEXT_LEVEL:
+        m_isCheater = true;
+        m_recording->addInput(m_gameState->getTick(), Recording::NEXT_LEVEL);
+        nextLevel();
+        break;
+    default:
+        if (Recording::getInputDirection(p_input) != Maze::NONE) {
+            m_input = Recording::getInputDirection(p_input);
+        }
+        break;
     }
 }
 
-void Game::ghostDeath(Ghost *p_ghost)
+void Game::playLeftInputs()
 {
-    m_nbEatenGhosts++;
-    p_ghost->setState(Ghost::EATEN);
-    winPoints(p_ghost);
+    Recording::Input input;
+
+    // The keys have been pressed while the Game was running, but it may have stopped since then
+    while (m_simulation->takeInput(input)) {
+        if (m_state == RUNNING) {
+            addInput(input);
+        }
+    }
 }
 
-void Game::winPoints(Element *p_element)
+void Game::tick()
 {
+    advanceTimeouts();
+    // The game waits while the Kapman blinks after its death, and until it is resumed once the pause has ended
+    if (isKapmanDying() || !m_timer->isActive()) {
+        return;
+    }
+    const int lives = getLives();
+    const bool isLevelStarted = SimulationThread::runTick(m_gameState, m_recording, m_isReplay, m_input);
+    m_input = Maze::NONE;
+    if (getLives() != lives) {
+        emit(livesChanged(getLives()));
+    }
+    if (isLevelStarted) {
+        // The player has changed the level before this tick : wait for a key press, as the player did
+        startNextLevel();
+        return;
+    }
+    updateCharacters();
+    handleEvents();
+}
 
-    // The value of won Points
-    long wonPoints;
+bool Game::seek(const int p_tick)
+{
+    const Recording::Keyframe *keyframe = m_isReplay ? m_recording->findKeyframe(p_tick) : NULL;
 
-    // If the eaten element is a ghost, win 200 * number of eaten ghosts since the energizer was eaten
-    if (p_element->getType() == Element::GHOST) {
-        if (m_soundEnabled) {
-            m_soundGhost.start();
+    if (keyframe == NULL) {
+        return false;
+    }
+    stopLoop();
+    if (!m_gameState->restoreState(keyframe->state)) {
+        return false;
+    }
+    m_recording->seek(*keyframe);
+    m_state = RUNNING;
+    m_input = Maze::NONE;
+    clearTimeouts();
+    // Run the ticks from the saved state to the wanted one without drawing them, going on after the deaths and the levels as the Game does
+    while (m_gameState->getTick() < p_tick && getLives() > 0) {
+        if (m_recording->playInputs(m_gameState, m_input)) {
+            continue;
+        }
+        m_gameState->step(m_input);
+        m_input = Maze::NONE;
+        const QVector<GameState::Event> &events = m_gameState->getEvents();
+        for (int i = 0; i < events.size(); ++i) {
+            if ((events[i].type == GameState::KAPMAN_DEATH && getLives() > 0) || events[i].type == GameState::LEVEL_COMPLETED) {
+                m_gameState->initCharacters();
+            }
         }
-
-        // Get the position of the ghost
-        qreal xPos = p_element->getX();
-        qreal yPos = p_element->getY();
-        // Add points to the score
-        wonPoints = p_element->getPoints() * m_nbEatenGhosts;
-        // Send to the scene the number of points to display and its position
-        emit(pointsToDisplay(wonPoints, xPos, yPos));
     }
-    // Else you just win the value of the element
-    else {
-        wonPoints = p_element->getPoints();
+    if (getLives() <= 0) {
+        emit(gameOver(true));
+        return true;
     }
 
-    // Update of the points value
-    m_points += wonPoints;
+    // Show the reached state, the replay going on once a key is pressed
+    showState();
+    return true;
+}
 
-    // For each 10000 points we get a life more
-    if (m_points / 10000 > (m_points - wonPoints) / 10000) {
-        if (m_soundEnabled) {
-            m_soundGainLife.start();
+void Game::showState()
+{
+    // Show the pending changes before the level is shown again from the beginning
+    publishFrame();
+    m_bonus->setPoints(m_gameState->getBonusPoints());
+    emit(levelStarted(true));
+    m_frame.kapman |= m_kapman->init(m_gameState->getKapman());
+    for (int i = 0; i < m_ghosts.size(); ++i) {
+        const GameState::GhostData ghost = m_gameState->getGhost(i);
+        m_frame.ghosts[i] |= m_ghosts[i]->update(ghost);
+        m_frame.ghosts[i] |= m_ghosts[i]->updatePosition(ghost, 1.0);
+    }
+    const int nbCells = m_maze->getNbRows() * m_maze->getNbColumns();
+    for (int i = 0; i < nbCells; ++i) {
+        if (m_maze->getConsumable(i) != Maze::NO_CONSUMABLE && m_gameState->getConsumable(i) == Maze::NO_CONSUMABLE) {
+            m_frame.eatenCells.append(i);
         }
-
-        m_lives++;
-        emit(livesChanged(m_lives));
     }
-    // If the eaten element is an energyzer we change the ghosts state
-    if (p_element->getType() == Element::ENERGYZER) {
-        // We start the prey timer
-        m_preyTimer->start();
+    publishFrame();
+    if (m_gameState->isBonusVisible()) {
+        emit(bonusOn());
+    } else {
+        emit(bonusOff());
+    }
+    emit(scoreChanged(getScore()));
+    emit(livesChanged(getLives()));
+    emit(levelChanged(getLevel()));
+}
 
-        if (m_soundEnabled) {
-            m_soundEnergizer.start();
+void Game::update()
+{
+    // The Game timeouts are advanced without the simulation thread while the Kapman blinks after its death
+    if (m_simulation != NULL && !isKapmanDying()) {
+        updateFromSimulation();
+        return;
+    }
+    if (m_turboTicks > 0) {
+        // Run the ticks without waiting for the clock, and only draw the last one
+        for (int i = 0; i < m_turboTicks && m_timer->isActive(); ++i) {
+            tick();
         }
+        updatePositions(1.0);
+        publishFrame();
+        return;
+    }
 
-        for (int i = 0; i < m_ghosts.size(); ++i) {
-            if (m_ghosts[i]->getState() != Ghost::EATEN) {
-                m_ghosts[i]->setState(Ghost::PREY);
-            }
-        }
-        // Reset the number of eaten ghosts
-        m_nbEatenGhosts = 0;
-        emit(elementEaten(p_element->getX(), p_element->getY()));
-    } else if (p_element->getType() == Element::PILL) {
-        if (m_soundEnabled) {
-            m_soundPill.start();
-        }
+    const qint64 tickDuration = Q_INT64_C(1000000000) / GameState::TICKS_PER_SECOND;
+    const qint64 time = m_clock.nsecsElapsed();
 
-        emit(elementEaten(p_element->getX(), p_element->getY()));
-    } else if (p_element->getType() == Element::BONUS) {
-        if (m_soundEnabled) {
-            m_soundBonus.start();
-        }
+    // After a long stall, give up the ticks that cannot be caught up : the game slows down instead of jumping forward
+    if (time - m_simulatedTime > MAX_TICKS_PER_FRAME * tickDuration) {
+        m_simulatedTime = time - MAX_TICKS_PER_FRAME * tickDuration;
+    }
+    // Run the ticks the clock has reached, unless one of them stops the game
+    while (m_simulatedTime + tickDuration <= time && m_timer->isActive()) {
+        tick();
+        m_simulatedTime += tickDuration;
+    }
+    // Draw the characters between the last two ticks, unless they wait for the end of the death pause
+    if (m_timer->isActive() && !isKapmanDying()) {
+        updatePositions(qreal(time - m_simulatedTime) / tickDuration);
+    } else {
+        updatePositions(1.0);
+    }
+    publishFrame();
+}
 
-        // Get the position of the Bonus
-        qreal xPos = p_element->getX();
-        qreal yPos = p_element->getY();
+void Game::updateFromSimulation()
+{
+    const qint64 tickDuration = Q_INT64_C(1000000000) / GameState::TICKS_PER_SECOND;
 
-        // Sends to the scene the number of points to display and its position
-        emit(pointsToDisplay(wonPoints, xPos, yPos));
+    if (!m_simulation->isStarted()) {
+        m_simulation->start(*m_gameState, m_clock, m_simulatedTime, m_input, m_turboTicks > 0);
+        m_input = Maze::NONE;
+    }
+    const SimulationThread::Frame *frame = m_simulation->takeFrame(getTick());
+    if (frame != NULL) {
+        applySimulationFrame(*frame);
+    }
+    // Draw the characters between the last two ticks the thread has run, as the clock goes on
+    if (m_simulation->isStarted() && m_turboTicks == 0) {
+        updatePositions(qBound(qreal(0), qreal(m_clock.nsecsElapsed() - m_simulatedTime) / tickDuration, qreal(1)));
+    } else {
+        updatePositions(1.0);
+    }
+    publishFrame();
+}
 
-        emit(bonusOff());
+void Game::applySimulationFrame(const SimulationThread::Frame &p_frame)
+{
+    const int lastTick = getTick();
+    const int lives = getLives();
+    int event = 0;
+
+    if (p_frame.stopped) {
+        m_simulation->stop();
     }
-    // If 1/3 or 2/3 of the pills are eaten
-    if (m_maze->getNbElem() == m_maze->getTotalNbElem() / 3 || m_maze->getNbElem() == (m_maze->getTotalNbElem() * 2 / 3)) {
-        // Display the Bonus
-        emit(bonusOn());
-        m_bonusTimer->start();
+    m_gameState->restoreSnapshot(p_frame.state.constData(), p_frame.state.size());
+    m_isCheater = m_isCheater || p_frame.cheated;
+    m_simulatedTime = p_frame.time;
+    updateCharacters();
+    // The lives lost are shown after the death pause, the cheats and the replay only adding lives
+    if (getLives() > lives) {
+        emit(livesChanged(getLives()));
+    }
+    // Advance the Game timeouts tick after tick, with the events of each tick, as tick() does
+    while (event < p_frame.events.size() && p_frame.events[event].tick <= lastTick) {
+        ++event;
+    }
+    for (int tick = lastTick + 1; tick <= getTick(); ++tick) {
+        advanceTimeouts();
+        while (event < p_frame.events.size() && p_frame.events[event].tick == tick) {
+            handleEvent(p_frame.events[event].event);
+            ++event;
+        }
+    }
+    if (p_frame.levelStarted) {
+        startNextLevel();
+    }
+    if (p_frame.stopped) {
+        playLeftInputs();
     }
-    emit(scoreChanged(m_points));
 }
 
-void Game::nextLevel()
+void Game::kapmanDeath()
 {
     if (m_soundEnabled) {
-        m_soundLevelUp.start();
+        m_soundGameOver.start();
     }
 
-    // Increment the level
-    m_level++;
-    // Initialize the maze items
-    m_maze->resetNbElem();
-    // Update Bonus
-    m_bonus->setPoints(m_level * 100);
-    // Move all characters to their initial positions
-    initCharactersPosition();
-    // Increase the ghosts speed
-    for (int i = 0; i < m_ghosts.size(); ++i) {
-        // Increase the ghosts speed increase
-        m_ghosts[i]->increaseCharactersSpeed();
+    m_frame.kapman |= m_kapman->die();
+    // Make a pause while the kapman is blinking : it is counted in ticks, so that it follows the simulated time,
+    // and locked, so that the player can neither move, cheat nor pause until resumeAfterKapmanDeath()
+    m_timeouts.add(DEATH_TIMEOUT, DEATH_DURATION * GameState::TICKS_PER_SECOND / 1000);
+    m_state = PAUSED_LOCKED;
+    emit(pauseChanged(true, false));
+}
+
+void Game::advanceTimeouts()
+{
+    const QVector<int> &expired = m_timeouts.advance();
+
+    for (int i = 0; i < expired.size(); ++i) {
+        switch (expired[i]) {
+        case DEATH_TIMEOUT:
+            // Resume from the event loop, as the game may be over and the Game deleted
+            m_timer->stop();
+            QTimer::singleShot(0, this, SLOT(resumeAfterKapmanDeath()));
+            break;
+        case POINTS_TIMEOUT:
+            // The points may have been won during this frame
+            publishFrame();
+            emit(pointsHidden());
+            break;
+        }
+    }
+    // The Kapman blinks during the pause after its death
+    if (isKapmanDying()) {
+        const int blinkTicks = KAPMAN_BLINK_DURATION * GameState::TICKS_PER_SECOND / 1000;
+        const int elapsedTicks = DEATH_DURATION * GameState::TICKS_PER_SECOND / 1000 - m_timeouts.getRemainingTicks(DEATH_TIMEOUT);
+        m_frame.kapman |= m_kapman->setNbBlinks(qMin(elapsedTicks / blinkTicks, KAPMAN_NB_BLINKS));
     }
-    m_kapman->increaseCharactersSpeed();
-    // Update the timers duration with the new speed
-    setTimersDuration();
-    // Update the score, level and lives labels
-    emit(scoreChanged(m_points));
-    emit(livesChanged(m_lives));
-    emit(levelChanged(m_level));
-    // Update the view
-    emit(levelStarted(true));
 }
 
-void Game::hideBonus()
+void Game::clearTimeouts()
 {
-    emit(bonusOff());
+    const int nbPoints = m_timeouts.remove(POINTS_TIMEOUT);
+
+    if (nbPoints > 0) {
+        publishFrame();
+    }
+    for (int i = 0; i < nbPoints; ++i) {
+        emit(pointsHidden());
+    }
+    m_timeouts.clear();
 }
 
-void Game::endPreyState()
+bool Game::isKapmanDying() const
 {
-    for (int i = 0; i < m_ghosts.size(); ++i) {
-        if (m_ghosts[i]->getState() != Ghost::EATEN) {
-            m_ghosts[i]->setState(Ghost::HUNTER);
-        }
+    return m_timeouts.getRemainingTicks(DEATH_TIMEOUT) > 0;
+}
+
+void Game::resumeAfterKapmanDeath()
+{
+    emit(livesChanged(getLives()));
+    // Start the timer
+    start();
+    // Remove a possible bonus
+    emit(bonusOff());
+    // If their is no lives left, we start a new game
+    if (getLives() <= 0) {
+        emit(gameOver(true));
+    } else {
+        emit(levelStarted(false));
+        // Move all characters to their initial positions
+        initCharactersPosition();
     }
 }
+
+void Game::nextLevel()
+{
+    m_gameState->nextLevel();
+    startNextLevel();
+}
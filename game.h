@@ -20,12 +20,18 @@
 #define GAME_H
 
 #include "maze.h"
+#include "gamestate.h"
 #include "kapman.h"
 #include "ghost.h"
 #include "bonus.h"
+#include "recording.h"
+#include "simulationthread.h"
+#include "timingwheel.h"
 
+#include <QElapsedTimer>
 #include <QPointF>
 #include <QTimer>
+#include <QVector>
 #include <QKeyEvent>
 #include <KgSound>
 
@@ -38,19 +44,52 @@ class Game : public QObject
     Q_OBJECT
 
 public :
-    /** Ratio which modify the timers function of the difficulty */
-    static qreal s_durationRatio;
-
-    /** Timer duration for prey state in medium difficulty */
-    static int s_preyStateDuration;
+    /** Points won by eating a Ghost or the Bonus, to display where they have been won */
+    struct WonPoints {
+        long points;
+        qreal x;
+        qreal y;
+    };
 
-    /** Timer duration for bonus apparition in medium difficulty */
-    static int s_bonusDuration;
+    /**
+     * What has changed since the previous frame, gathered during the ticks of a frame and shown by the view at once.
+     * The changes of the characters are Character::Change bits, which the view reads the new values for from the models.
+     */
+    struct Frame {
+        /** The changes of the Kapman */
+        int kapman;
+        /** The changes of each Ghost */
+        QVector<int> ghosts;
+        /** The Cells whose Pill or Energizer has been eaten */
+        QVector<int> eatenCells;
+        /** The won points to display, in the order they have been won */
+        QVector<WonPoints> wonPoints;
+        /** True if the score has changed */
+        bool scoreChanged;
+    };
 
 private :
 
-    /** Number of FPS */
-    static const int FPS;
+    /** The maximum number of ticks run in a frame to catch up with the clock */
+    static const int MAX_TICKS_PER_FRAME;
+
+    /** Duration of the pause after the Kapman death, in milliseconds */
+    static const int DEATH_DURATION;
+
+    /** Duration of the display of won points, in milliseconds */
+    static const int POINTS_DURATION;
+
+    /** Duration of a Kapman blink after its death, in milliseconds */
+    static const int KAPMAN_BLINK_DURATION;
+
+    /** Number of times the Kapman blinks after its death */
+    static const int KAPMAN_NB_BLINKS;
+
+    /** Number of parts the prey state is divided into, the Ghosts blinking once per part */
+    static const int GHOST_BLINK_PARTS;
+
+    /** Number of parts of the prey state after which the Ghosts start blinking */
+    static const int GHOST_START_BLINKING_PART;
 
     /** The game different states : RUNNING, PAUSED_LOCKED, PAUSED_UNLOCKED */
     enum State {
@@ -61,21 +100,51 @@ private :
     /** A flag for the State enum */
     Q_DECLARE_FLAGS(GameStates, State)
 
+    /** The timeouts of the Game, which only change the way the game is shown */
+    enum Timeout {
+        DEATH_TIMEOUT,      // The pause after the Kapman death ends
+        POINTS_TIMEOUT      // The oldest displayed won points disappear
+    };
+
     /** The game state */
     State m_state;
 
-    /** The Game main timer */
+    /** The Game main timer, which draws a frame each time the screen is refreshed */
     QTimer *m_timer;
 
-    /** The Bonus timer to make it disappear if it is not eaten after a given time */
-    QTimer *m_bonusTimer;
+    /** The clock the ticks are run against, started when the Game timer is */
+    QElapsedTimer m_clock;
+
+    /** The clock time the ticks run so far have reached, in nanoseconds */
+    qint64 m_simulatedTime;
+
+    /** The number of ticks run at each frame without waiting for the clock, 0 to run the ticks at the clock rate */
+    int m_turboTicks;
+
+    /** The interval of the Game timer when the ticks are run at the clock rate, in milliseconds */
+    int m_frameInterval;
 
-    /** Timer to manage the prey state of the ghosts */
-    QTimer *m_preyTimer;
+    /** The thread the ticks are run on, NULL to run them on the Game thread */
+    SimulationThread *m_simulation;
+
+    /** The timeouts, which expire as the ticks are run : the game ones are in the GameState */
+    TimingWheel m_timeouts;
 
     /** The Maze */
     Maze *m_maze;
 
+    /** The state of the game, which the characters below show, copied from the simulation thread when it runs */
+    GameState *m_gameState;
+
+    /** The Direction the player has asked for since the last tick, Maze::NONE if none */
+    Maze::Direction m_input;
+
+    /** The Recording of the game inputs, or the one being played */
+    Recording *m_recording;
+
+    /** True if the Game plays a Recording, false if it records the player inputs */
+    bool m_isReplay;
+
     /** The main Character */
     Kapman *m_kapman;
 
@@ -85,21 +154,12 @@ private :
     /** The Bonus instance */
     Bonus *m_bonus;
 
+    /** The changes not shown yet */
+    Frame m_frame;
+
     /** A flag to know if the player has cheated during the game */
     bool m_isCheater;
 
-    /** The remaining number of lives */
-    int m_lives;
-
-    /** The won points */
-    long m_points;
-
-    /** The current game level */
-    int m_level;
-
-    /** The number of eaten ghosts since the beginning of the current level */
-    int m_nbEatenGhosts;
-
     /** Flag if sound is enabled */
     bool m_soundEnabled;
 
@@ -115,8 +175,15 @@ public:
 
     /**
      * Creates a new Game instance.
+     * @param p_seed the seed of the random-number generator, the same seed giving the same game for the same key presses
      */
-    Game();
+    explicit Game(const quint64 p_seed);
+
+    /**
+     * Creates a new Game instance which plays a Recording again.
+     * @param p_replay the Recording to play, which the Game takes the ownership of
+     */
+    explicit Game(Recording *p_replay);
 
     /**
      * Deletes the Game instance.
@@ -125,6 +192,7 @@ public:
 
     /**
      * Starts the Game.
+     * While the Kapman is dying, the pause stays locked until the end of its death.
      */
     void start();
 
@@ -170,6 +238,48 @@ public:
      */
     bool isPaused() const;
 
+    /**
+     * Runs the ticks as fast as possible instead of at the clock rate, to fast-forward the game.
+     * All the game timers follow the ticks, so the game goes on as it would at the clock rate.
+     * @param p_ticksPerFrame the number of ticks to run before drawing each frame, 0 to go back to the clock rate
+     */
+    void setTurbo(const int p_ticksPerFrame);
+
+    /**
+     * Runs the ticks on a thread of their own, so that drawing a slow frame does not delay them.
+     * The Game thread then only shows the latest state the simulation thread has published.
+     * @param p_isThreaded true to run the ticks on a simulation thread, false to run them on the Game thread
+     */
+    void setThreaded(const bool p_isThreaded);
+
+    /**
+     * @return the seed of the random-number generator
+     */
+    quint64 getSeed() const;
+
+    /**
+     * @return the Recording of the game inputs
+     */
+    const Recording *getRecording() const;
+
+    /**
+     * @return true if the Game plays a Recording, false otherwise
+     */
+    bool isReplay() const;
+
+    /**
+     * Goes to a tick of the played Recording, from the last saved state of the game before it.
+     * The Game then waits for a key press to go on.
+     * @param p_tick the tick to go to
+     * @return true if the Game has gone to the tick, false if it does not play a Recording holding a state before it
+     */
+    bool seek(const int p_tick);
+
+    /**
+     * @return the number of ticks run since the beginning of the game
+     */
+    int getTick() const;
+
     /**
      * @return true if the player has cheated during the game, false otherwise
      */
@@ -197,48 +307,78 @@ public:
     void setLevel(int p_level);
 
     /**
-     * Create the new Bonus
-     * @param p_position the Bonus position
+     * Initializes a Ghost
      */
-    void createBonus(QPointF p_position);
+    void initGhost();
 
     /**
-     * Create the new Kapman
-     * @param p_position the Kapman position
+     * Initializes a Kapman
      */
-    void createKapman(QPointF p_position);
+    void initKapman();
 
     /**
-     * Create the new Ghost
-     * @param p_position the Ghost position
-     * @param p_imageId the image of the Ghost
+     * Enables / disables the sounds.
+     * @param p_enabled if true the sounds will be enabled, otherwise they will be disabled
      */
-    void createGhost(QPointF p_position, const QString &p_imageId);
+    void setSoundsEnabled(bool p_enabled);
+
+private:
 
     /**
-     * Initializes a Maze
-     * @param p_nbRows the number of rows
-     * @param p_nbColumns the number of columns
+     * Creates a new Game instance.
+     * @param p_recording the Recording of the game, which the Game takes the ownership of
+     * @param p_isReplay true if the Recording has to be played, false if the player inputs have to be recorded in it
      */
-    void initMaze(const int p_nbRows, const int p_nbColumns);
+    Game(Recording *p_recording, const bool p_isReplay);
 
     /**
-     * Initializes a Ghost
+     * Starts the Game timer and the clock the ticks are run against.
      */
-    void initGhost();
+    void startLoop();
 
     /**
-     * Initializes a Kapman
+     * Stops the Game timer, and the simulation thread if any, the GameState then going on from the last tick run.
      */
-    void initKapman();
+    void stopLoop();
 
     /**
-     * Enables / disables the sounds.
-     * @param p_enabled if true the sounds will be enabled, otherwise they will be disabled
+     * Gives the next tick the Direction the player has asked for.
+     * @param p_input the Direction
      */
-    void setSoundsEnabled(bool p_enabled);
+    void setInput(const Maze::Direction p_input);
 
-private:
+    /**
+     * Plays an input of the player : a Direction is given to the next tick, and a cheat is applied.
+     * The simulation thread plays the input before its next tick while it is started.
+     * @param p_input a Direction the player has asked for, or a cheat
+     */
+    void addInput(const Recording::Input p_input);
+
+    /**
+     * Plays the inputs the simulation thread has received after its last tick, once it has stopped,
+     * as if the player had just given them : they are dropped if the Game is not running anymore.
+     */
+    void playLeftInputs();
+
+    /**
+     * Advances the GameState by one tick.
+     */
+    void tick();
+
+    /**
+     * Advances the Game timeouts by one tick, and handles those which expire.
+     */
+    void advanceTimeouts();
+
+    /**
+     * Removes the Game timeouts, hiding the displayed won points.
+     */
+    void clearTimeouts();
+
+    /**
+     * @return true if the Game waits for the end of the pause after the Kapman death
+     */
+    bool isKapmanDying() const;
 
     /**
      * Initializes the character coordinates.
@@ -246,61 +386,83 @@ private:
     void initCharactersPosition();
 
     /**
-     * Calculates and update the ghosts speed depending on the ghosts speed
-     * The value is in Ghost::s_speed
+     * Updates the characters from their state in the GameState, after a tick.
      */
-    void setTimersDuration();
+    void updateCharacters();
 
-public slots:
+    /**
+     * Moves the characters between their coordinates before and after the last tick.
+     * @param p_alpha the elapsed part of the tick, from 0 (before the tick) to 1 (after the tick)
+     */
+    void updatePositions(const qreal p_alpha);
 
     /**
-     * Manages the key press events.
-     * @param p_event the key press event
+     * Turns the events of the last tick into sounds, signals and changes to show.
      */
-    void keyPressEvent(QKeyEvent *p_event);
+    void handleEvents();
 
     /**
-     * Resumes the Game after the Kapman death.
+     * Turns an event of the GameState into sounds, signals and changes to show.
+     * @param p_event the event
      */
-    void resumeAfterKapmanDeath();
+    void handleEvent(const GameState::Event &p_event);
 
-private slots:
+    /**
+     * Shows the latest state the simulation thread has published, starting the thread if needed.
+     */
+    void updateFromSimulation();
 
     /**
-     * Updates the Game data.
+     * Goes on from a state published by the simulation thread, handling its events as the ticks would have.
+     * @param p_frame the published state
      */
-    void update();
+    void applySimulationFrame(const SimulationThread::Frame &p_frame);
 
     /**
-     * Manages the loss of a life.
+     * Sends the changes gathered since the previous frame to the view, and starts gathering the next ones.
+     * It must be called before the signals the view has to receive after these changes.
      */
-    void kapmanDeath();
+    void publishFrame();
 
     /**
-     * Manages the death of a Ghost.
+     * Updates the whole view once the GameState has gone to another state.
      */
-    void ghostDeath(Ghost *p_ghost);
+    void showState();
 
     /**
-     * Increases the score considering the eaten Element.
-     * @param p_element the eaten Element
+     * Updates the view once the GameState has started a new level.
      */
-    void winPoints(Element *p_element);
+    void startNextLevel();
+
+public slots:
 
     /**
-     * Starts the next level.
+     * Manages the key press events.
+     * @param p_event the key press event
      */
-    void nextLevel();
+    void keyPressEvent(QKeyEvent *p_event);
 
     /**
-     * Hides the Bonus.
+     * Resumes the Game after the Kapman death.
      */
-    void hideBonus();
+    void resumeAfterKapmanDeath();
+
+private slots:
 
     /**
-     * Ends the Ghosts prey state.
+     * Runs the ticks the clock has reached since the last frame, then draws the characters between the last two ticks.
      */
-    void endPreyState();
+    void update();
+
+    /**
+     * Manages the loss of a life.
+     */
+    void kapmanDeath();
+
+    /**
+     * Starts the next level.
+     */
+    void nextLevel();
 
 signals:
 
@@ -329,11 +491,10 @@ signals:
     void pauseChanged(const bool p_pause, const bool p_fromUser);
 
     /**
-     * Emitted when an Element has been eaten.
-     * @param p_x the Element x-coordinate
-     * @param p_y the Element y-coordinate
+     * Emitted once per frame with what has changed since the previous frame.
+     * @param p_frame the changes, only valid during the signal
      */
-    void elementEaten(const qreal p_x, const qreal p_y);
+    void frameUpdated(const Game::Frame &p_frame);
 
     /**
      * Emitted when the Bonus has to be displayed.
@@ -364,13 +525,9 @@ signals:
     void livesChanged(unsigned int p_lives);
 
     /**
-     * Emitted when a ghost or a bonus is eaten. It tells to the scene to
-     * display the number of won points
-     * @param p_wonPoints the value to display
-     * @param p_xPos the x position of the label
-     * @param p_yPos the y position of the label
+     * Emitted when the oldest displayed won points have to disappear.
      */
-    void pointsToDisplay(long p_wonPoints, qreal p_xPos, qreal p_yPos);
+    void pointsHidden();
 };
 
 #endif
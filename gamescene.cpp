@@ -25,15 +25,18 @@
 
 GameScene::GameScene(Game *p_game) : m_game(p_game), m_kapmanItem(0), m_mazeItem(0)
 {
+    // The game state finds the collisions : the scene is never searched for items, so it does not index them as they move
+    setItemIndexMethod(QGraphicsScene::NoIndex);
+
+    connect(p_game, SIGNAL(frameUpdated(Game::Frame)), this, SLOT(applyFrame(Game::Frame)));
     connect(p_game, SIGNAL(levelStarted(bool)), SLOT(intro(bool)));
     connect(p_game, SIGNAL(gameStarted()), this, SLOT(start()));
     connect(p_game, SIGNAL(pauseChanged(bool,bool)), this, SLOT(setPaused(bool,bool)));
-    connect(p_game, SIGNAL(elementEaten(qreal,qreal)), this, SLOT(hideElement(qreal,qreal)));
     connect(p_game, SIGNAL(bonusOn()), this, SLOT(displayBonus()));
     connect(p_game, SIGNAL(bonusOff()), this, SLOT(hideBonus()));
 
-    // Connection between Game and GameScene for the display of won points when a bonus or a ghost is eaten
-    connect(p_game, SIGNAL(pointsToDisplay(long,qreal,qreal)), this, SLOT(displayPoints(long,qreal,qreal)));
+    // The won points are displayed with the changes of a frame, and hidden by the Game once their duration has elapsed
+    connect(p_game, SIGNAL(pointsHidden()), this, SLOT(hidePoints()));
 
     // Create the theme instance
     m_theme = new KGameTheme();
@@ -70,18 +73,19 @@ GameScene::GameScene(Game *p_game) : m_game(p_game), m_kapmanItem(0), m_mazeItem
         ghost->setZValue(3);
         m_ghostItems.append(ghost);
     }
-    // Create the Pill and Energizer items
-    m_elementItems = new ElementItem **[m_game->getMaze()->getNbRows()];
+    // Create the Pill and Energizer items : they do not move, so they have no model but the Maze Cell they are on
+    m_elementItems = new QGraphicsSvgItem **[m_game->getMaze()->getNbRows()];
     for (int i = 0; i < m_game->getMaze()->getNbRows(); ++i) {
-        m_elementItems[i] = new ElementItem*[m_game->getMaze()->getNbColumns()];
+        m_elementItems[i] = new QGraphicsSvgItem*[m_game->getMaze()->getNbColumns()];
         for (int j = 0; j < m_game->getMaze()->getNbColumns(); ++j) {
-            if (m_game->getMaze()->getCell(i, j).getElement() != NULL) {
+            if (m_game->getMaze()->getConsumable(m_game->getMaze()->getCellIndex(i, j)) != Maze::NO_CONSUMABLE) {
                 // Create the element and set the image
-                ElementItem *element = new ElementItem(m_game->getMaze()->getCell(i, j).getElement());
+                QGraphicsSvgItem *element = new QGraphicsSvgItem();
                 element->setSharedRenderer(m_renderer);
-                element->setElementId(m_game->getMaze()->getCell(i, j).getElement()->getImageId());
-                element->update(m_game->getMaze()->getCell(i, j).getElement()->getX(), m_game->getMaze()->getCell(i, j).getElement()->getY());
+                element->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+                element->setMaximumCacheSize(QSize(500, 500));
                 m_elementItems[i][j] = element;
+                updateElementItem(i, j);
             } else {
                 m_elementItems[i][j] = NULL;
             }
@@ -201,9 +205,7 @@ void GameScene::updateSvgIds()
     for (int i = 0; i < m_game->getMaze()->getNbRows(); ++i) {
         for (int j = 0; j < m_game->getMaze()->getNbColumns(); ++j) {
             if (m_elementItems[i][j] != NULL) {
-                ElementItem *element = m_elementItems[i][j];
-                element->setElementId(m_game->getMaze()->getCell(i, j).getElement()->getImageId());
-                element->update(m_game->getMaze()->getCell(i, j).getElement()->getX(), m_game->getMaze()->getCell(i, j).getElement()->getY());
+                updateElementItem(i, j);
             }
         }
     }
@@ -310,10 +312,30 @@ void GameScene::setPaused(const bool p_pause, const bool p_fromUser)
     }
 }
 
-void GameScene::hideElement(const qreal p_x, const qreal p_y)
+void GameScene::applyFrame(const Game::Frame &p_frame)
 {
-    if (items().contains(m_elementItems[(int)((p_y - (Cell::SIZE * 0.5)) / Cell::SIZE)][(int)((p_x - (Cell::SIZE * 0.5)) / Cell::SIZE)])) {
-        removeItem(m_elementItems[(int)((p_y - (Cell::SIZE * 0.5)) / Cell::SIZE)][(int)((p_x - (Cell::SIZE * 0.5)) / Cell::SIZE)]);
+    if (p_frame.kapman != Character::NO_CHANGE) {
+        m_kapmanItem->applyChanges(p_frame.kapman);
+    }
+    for (int i = 0; i < p_frame.ghosts.size(); ++i) {
+        if (p_frame.ghosts[i] != Character::NO_CHANGE) {
+            m_ghostItems[i]->applyChanges(p_frame.ghosts[i]);
+        }
+    }
+    for (int i = 0; i < p_frame.eatenCells.size(); ++i) {
+        hideElement(p_frame.eatenCells[i]);
+    }
+    for (int i = 0; i < p_frame.wonPoints.size(); ++i) {
+        displayPoints(p_frame.wonPoints[i].points, p_frame.wonPoints[i].x, p_frame.wonPoints[i].y);
+    }
+}
+
+void GameScene::hideElement(const int p_index)
+{
+    QGraphicsSvgItem *element = m_elementItems[m_game->getMaze()->getRowFromIndex(p_index)][m_game->getMaze()->getColumnFromIndex(p_index)];
+
+    if (element != NULL && element->scene() == this) {
+        removeItem(element);
     }
 }
 
@@ -357,9 +379,6 @@ void GameScene::hideBonus()
 
 void GameScene::displayPoints(long p_wonPoints, qreal p_xPos, qreal p_yPos)
 {
-    // Launch a singleShot timer
-    QTimer::singleShot(1000, this, SLOT(hidePoints()));
-
     // Add a label in the list of won points Labels
     m_wonPointsLabels.prepend(new QGraphicsTextItem(QString::number(p_wonPoints)));
     addItem(m_wonPointsLabels.first());
@@ -381,3 +400,16 @@ void GameScene::hidePoints()
     // Remove the oldest item from the list
     delete m_wonPointsLabels.takeLast();
 }
+
+void GameScene::updateElementItem(const int p_row, const int p_column)
+{
+    QGraphicsSvgItem *element = m_elementItems[p_row][p_column];
+
+    if (m_game->getMaze()->getConsumable(m_game->getMaze()->getCellIndex(p_row, p_column)) == Maze::ENERGIZER) {
+        element->setElementId(QLatin1Literal("energizer"));
+    } else {
+        element->setElementId(QLatin1Literal("pill"));
+    }
+    element->setPos(Cell::SIZE * (p_column + 0.5) - element->boundingRect().width() / 2,
+                    Cell::SIZE * (p_row + 0.5) - element->boundingRect().height() / 2);
+}
@@ -54,8 +54,8 @@ private:
     /** The GhostItem of each Ghost to be drawn */
     QList<GhostItem *> m_ghostItems;
 
-    /** The ElementItem to be drawn (each Pill and Energizers) */
-    ElementItem ** *m_elementItems;
+    /** The item of each Pill and Energizer to be drawn, by row and column, NULL for the Cells which hold none */
+    QGraphicsSvgItem ** *m_elementItems;
 
     /** The Bonus ElementItem */
     ElementItem *m_bonusItem;
@@ -100,6 +100,12 @@ public:
 
 private slots:
 
+    /**
+     * Shows what has changed since the previous frame, in a single pass over the characters.
+     * @param p_frame the changes
+     */
+    void applyFrame(const Game::Frame &p_frame);
+
     /**
      * Updates the elements to be drawn on Game introduction.
      * @param p_newLevel true a new level has begun, false otherwise
@@ -118,14 +124,6 @@ private slots:
      */
     void setPaused(const bool p_pause, const bool p_fromUser);
 
-    /**
-     * Removes the Element at the given coordinates from the GameScene.
-     * @param p_wonPoints value of the won Points, used when a ghost or a Bonus is eaten
-     * @param p_x x-coordinate of the Element
-     * @param p_y y-coordinate of the Element
-     */
-    void hideElement(const qreal p_x, const qreal p_y);
-
     /**
      * Displays the Bonus.
      */
@@ -136,14 +134,6 @@ private slots:
      */
     void hideBonus();
 
-    /**
-     * Display won Points on the scene when a Bonus or a Ghosts is eaten
-     * @param p_wonPoints the value to display
-     * @param p_xPos the position of the eaten element on X axis
-     * @param p_yPos the position of the eaten element on Y axis
-     */
-    void displayPoints(long p_wonPoints, qreal p_xPos, qreal p_yPos);
-
     /**
      * Hide the first label in the list of won points labels
      */
@@ -158,6 +148,29 @@ private slots:
      * Update theme properties.
      */
     void updateThemeProperties();
+
+private:
+
+    /**
+     * Removes the Pill or Energizer of a Cell from the GameScene.
+     * @param p_index the Cell index
+     */
+    void hideElement(const int p_index);
+
+    /**
+     * Display won Points on the scene when a Bonus or a Ghosts is eaten
+     * @param p_wonPoints the value to display
+     * @param p_xPos the position of the eaten element on X axis
+     * @param p_yPos the position of the eaten element on Y axis
+     */
+    void displayPoints(long p_wonPoints, qreal p_xPos, qreal p_yPos);
+
+    /**
+     * Sets the image of the item of a Pill or an Energizer, and centers it on its Cell.
+     * @param p_row the Cell row
+     * @param p_column the Cell column
+     */
+    void updateElementItem(const int p_row, const int p_column);
 };
 
 #endif
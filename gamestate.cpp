@@ -0,0 +1,905 @@
+/*
+ * Copyright 2007-2008 Thomas Gallinari <tg8187@yahoo.fr>
+ * Copyright 2007-2008 Pierre-Benoît Besse <besse.pb@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamestate.h"
+
+#include <QBitArray>
+#include <QDataStream>
+#include <QtGlobal>
+
+#include <cstring>
+
+const int GameState::TICKS_PER_SECOND = 40;
+const int GameState::SPEED_FRACTION_BITS = 8;
+const int GameState::LOW_SPEED = 48;
+const int GameState::MEDIUM_SPEED = 58;
+const int GameState::HIGH_SPEED = 67;
+const int GameState::LOW_SPEED_INC = 50;
+const int GameState::MEDIUM_SPEED_INC = 100;
+const int GameState::HIGH_SPEED_INC = 200;
+const int GameState::PREY_STATE_DURATION = 10000;
+const int GameState::BONUS_DURATION = 7000;
+
+namespace
+{
+/** The Kapman maximum speed, in percent of its initial speed */
+const int KAPMAN_MAX_SPEED_PERCENT = 150;
+/** The Ghosts maximum speed, in percent of their initial speed */
+const int GHOST_MAX_SPEED_PERCENT = 200;
+/** The Kapman speed increase when level up, in percent of the Ghosts one */
+const int KAPMAN_SPEED_INC_PERCENT = 50;
+/** Points won when a pill is eaten */
+const int PILL_POINTS = 10;
+/** Points won when an energizer is eaten */
+const int ENERGIZER_POINTS = 50;
+/** Points won when a Ghost is eaten, multiplied by the number of Ghosts eaten since the last energizer */
+const int GHOST_POINTS = 200;
+/** The distance under which the Kapman touches a Ghost or the Bonus */
+const int HIT_DISTANCE = Cell::SUBCELLS / 2;
+/** The number of bytes of the arrays of one Ghost in a snapshot : the current and previous coordinates, the Direction and the state */
+const int GHOST_SNAPSHOT_SIZE = 4 * sizeof(qint32) + 2 * sizeof(quint8);
+
+/**
+ * Checks two points are closer than the hit distance.
+ * The distances are bounded first, so that their squares cannot overflow and the check needs no branch.
+ */
+bool isHit(const int p_x1, const int p_y1, const int p_x2, const int p_y2)
+{
+    const int dx = qBound(-HIT_DISTANCE, p_x2 - p_x1, HIT_DISTANCE);
+    const int dy = qBound(-HIT_DISTANCE, p_y2 - p_y1, HIT_DISTANCE);
+    return dx * dx + dy * dy < HIT_DISTANCE * HIT_DISTANCE;
+}
+
+/**
+ * Gets the speed a character moves at from a speed with GameState::SPEED_FRACTION_BITS more bits, rounded to the nearest unit.
+ */
+int roundSpeed(const int p_speed)
+{
+    return (p_speed + (1 << (GameState::SPEED_FRACTION_BITS - 1))) >> GameState::SPEED_FRACTION_BITS;
+}
+
+/**
+ * Gets the move of a character during a tick, from its Direction and its speed, without branching.
+ */
+void getMove(const int p_direction, const int p_speed, int &p_dx, int &p_dy)
+{
+    p_dx = ((p_direction & Maze::RIGHT) ? p_speed : 0) - ((p_direction & Maze::LEFT) ? p_speed : 0);
+    p_dy = ((p_direction & Maze::DOWN) ? p_speed : 0) - ((p_direction & Maze::UP) ? p_speed : 0);
+}
+
+/**
+ * Copies an array to a snapshot, and moves the snapshot pointer past it.
+ */
+template<typename T>
+void saveArray(char *&p_data, const QVector<T> &p_array)
+{
+    memcpy(p_data, p_array.constData(), p_array.size() * sizeof(T));
+    p_data += p_array.size() * sizeof(T);
+}
+
+/**
+ * Copies an array from a snapshot, and moves the snapshot pointer past it.
+ */
+template<typename T>
+void restoreArray(const char *&p_data, QVector<T> &p_array)
+{
+    memcpy(p_array.data(), p_data, p_array.size() * sizeof(T));
+    p_data += p_array.size() * sizeof(T);
+}
+
+/**
+ * Writes the speeds of a character.
+ */
+QDataStream &operator<<(QDataStream &p_stream, const GameState::SpeedData &p_speed)
+{
+    return p_stream << p_speed.normalSpeed << p_speed.speedIncrease << p_speed.maxSpeed;
+}
+
+/**
+ * Reads the speeds of a character.
+ */
+QDataStream &operator>>(QDataStream &p_stream, GameState::SpeedData &p_speed)
+{
+    return p_stream >> p_speed.normalSpeed >> p_speed.speedIncrease >> p_speed.maxSpeed;
+}
+
+/**
+ * Writes the changing part of a character state.
+ */
+QDataStream &operator<<(QDataStream &p_stream, const GameState::CharacterData &p_character)
+{
+    return p_stream << p_character.x << p_character.y << quint8(p_character.direction) << p_character.speed
+           << static_cast<const GameState::SpeedData &>(p_character);
+}
+
+/**
+ * Reads the changing part of a character state, the character being drawn from the read coordinates.
+ */
+QDataStream &operator>>(QDataStream &p_stream, GameState::CharacterData &p_character)
+{
+    quint8 direction;
+
+    p_stream >> p_character.x >> p_character.y >> direction >> p_character.speed
+             >> static_cast<GameState::SpeedData &>(p_character);
+    p_character.direction = Maze::Direction(direction);
+    p_character.previousX = p_character.x;
+    p_character.previousY = p_character.y;
+    return p_stream;
+}
+}
+
+GameState::GameState(const Maze *p_maze, const Difficulty p_difficulty, const quint64 p_seed) :
+    m_maze(p_maze),
+    m_difficulty(p_difficulty),
+    m_seed(p_seed),
+    m_random(p_seed),
+    m_tick(0),
+    m_bonusX(0),
+    m_bonusY(0),
+    m_nbElem(0),
+    m_lives(3),
+    m_points(0),
+    m_level(1),
+    m_nbEatenGhosts(0)
+{
+    m_kapman.xInit = 0;
+    m_kapman.yInit = 0;
+    initSpeed(m_kapman, KAPMAN_MAX_SPEED_PERCENT, KAPMAN_SPEED_INC_PERCENT);
+    m_kapman.speed = roundSpeed(m_kapman.normalSpeed);
+    initSpeed(m_ghostSpeed, GHOST_MAX_SPEED_PERCENT, 100);
+}
+
+GameState::~GameState()
+{
+}
+
+void GameState::setKapman(const int p_x, const int p_y)
+{
+    m_kapman.xInit = p_x;
+    m_kapman.yInit = p_y;
+    m_kapman.x = p_x;
+    m_kapman.y = p_y;
+    m_kapman.previousX = p_x;
+    m_kapman.previousY = p_y;
+}
+
+void GameState::addGhost(const int p_x, const int p_y)
+{
+    m_ghosts.xInit.append(p_x);
+    m_ghosts.yInit.append(p_y);
+    m_ghosts.x.append(p_x);
+    m_ghosts.y.append(p_y);
+    m_ghosts.previousX.append(p_x);
+    m_ghosts.previousY.append(p_y);
+    m_ghosts.direction.append(Maze::LEFT);
+    m_ghosts.state.append(HUNTER);
+    m_ghostMarks.append(0);
+}
+
+void GameState::setBonus(const int p_x, const int p_y)
+{
+    m_bonusX = p_x;
+    m_bonusY = p_y;
+}
+
+void GameState::resetConsumables()
+{
+    m_consumables = m_maze->getConsumables();
+    m_nbElem = m_maze->getTotalNbElem();
+}
+
+void GameState::setSeed(const quint64 p_seed)
+{
+    m_seed = p_seed;
+    m_random.seed(p_seed);
+}
+
+void GameState::initCharacters()
+{
+    // The Kapman starts going to the right
+    m_kapman.x = m_kapman.xInit;
+    m_kapman.y = m_kapman.yInit;
+    m_kapman.previousX = m_kapman.x;
+    m_kapman.previousY = m_kapman.y;
+    m_kapman.speed = roundSpeed(m_kapman.normalSpeed);
+    m_kapman.askedDirection = Maze::NONE;
+    m_kapman.direction = Maze::RIGHT;
+    // The Ghosts start as hunters going to the left
+    m_ghosts.x = m_ghosts.xInit;
+    m_ghosts.y = m_ghosts.yInit;
+    m_ghosts.previousX = m_ghosts.xInit;
+    m_ghosts.previousY = m_ghosts.yInit;
+    m_ghosts.direction.fill(Maze::LEFT);
+    m_ghosts.state.fill(HUNTER);
+    m_timeouts.clear();
+    m_nbEatenGhosts = 0;
+}
+
+void GameState::step(const Maze::Direction p_input)
+{
+    m_events.clear();
+    ++m_tick;
+    if (p_input != Maze::NONE) {
+        m_kapman.askedDirection = p_input;
+    }
+
+    // Keep the coordinates before the tick
+    m_kapman.previousX = m_kapman.x;
+    m_kapman.previousY = m_kapman.y;
+    // A copy rather than an assignment, which would share the arrays and copy them again when the Ghosts move
+    memcpy(m_ghosts.previousX.data(), m_ghosts.x.constData(), m_ghosts.x.size() * sizeof(qint32));
+    memcpy(m_ghosts.previousY.data(), m_ghosts.y.constData(), m_ghosts.y.size() * sizeof(qint32));
+
+    // Handle the timeouts which expire at this tick
+    const QVector<int> &expired = m_timeouts.advance();
+    for (int i = 0; i < expired.size(); ++i) {
+        switch (expired[i]) {
+        case PREY_TIMEOUT: {
+            quint8 *state = m_ghosts.state.data();
+            const int nbGhosts = m_ghosts.state.size();
+            for (int j = 0; j < nbGhosts; ++j) {
+                state[j] = state[j] == EATEN ? quint8(EATEN) : quint8(HUNTER);
+            }
+            break;
+        }
+        case BONUS_TIMEOUT:
+            addEvent(BONUS_OFF);
+            break;
+        }
+    }
+
+    updateGhosts();
+    updateKapman();
+    handleCollisions();
+}
+
+void GameState::nextLevel()
+{
+    ++m_level;
+    initLevel(1);
+}
+
+void GameState::setLevel(const int p_level)
+{
+    m_level = p_level;
+    initSpeed(m_kapman, KAPMAN_MAX_SPEED_PERCENT, KAPMAN_SPEED_INC_PERCENT);
+    initSpeed(m_ghostSpeed, GHOST_MAX_SPEED_PERCENT, 100);
+    initLevel(m_level);
+}
+
+void GameState::addLife()
+{
+    ++m_lives;
+}
+
+QByteArray GameState::saveState() const
+{
+    QByteArray state;
+    QDataStream stream(&state, QIODevice::WriteOnly);
+    // Only keep whether each thing of the level is still there
+    QBitArray remaining(m_maze->getTotalNbElem());
+    int elem = 0;
+
+    for (int i = 0; i < m_consumables.size(); ++i) {
+        if (m_maze->getConsumable(i) != Maze::NO_CONSUMABLE) {
+            remaining.setBit(elem++, m_consumables[i] != Maze::NO_CONSUMABLE);
+        }
+    }
+    stream << m_random.getState() << qint32(m_tick) << qint32(m_lives) << qint64(m_points) << qint32(m_level)
+           << qint32(m_nbEatenGhosts) << m_timeouts << remaining;
+    stream << m_kapman << quint8(m_kapman.askedDirection) << m_ghostSpeed << qint32(getNbGhosts());
+    for (int i = 0; i < getNbGhosts(); ++i) {
+        stream << m_ghosts.x[i] << m_ghosts.y[i] << m_ghosts.direction[i] << m_ghosts.state[i];
+    }
+    return state;
+}
+
+bool GameState::restoreState(const QByteArray &p_state)
+{
+    QDataStream stream(p_state);
+    quint64 random;
+    qint32 tick, lives, level, nbEatenGhosts, nbGhosts;
+    qint64 points;
+    quint8 askedDirection;
+    QBitArray remaining;
+    TimingWheel timeouts;
+    KapmanData kapman = m_kapman;
+    SpeedData ghostSpeed;
+    GhostArrays ghosts = m_ghosts;
+
+    stream >> random >> tick >> lives >> points >> level >> nbEatenGhosts >> timeouts >> remaining;
+    stream >> kapman >> askedDirection >> ghostSpeed >> nbGhosts;
+    if (stream.status() != QDataStream::Ok || remaining.size() != m_maze->getTotalNbElem() || nbGhosts != getNbGhosts()) {
+        return false;
+    }
+    kapman.askedDirection = Maze::Direction(askedDirection);
+    for (int i = 0; i < nbGhosts; ++i) {
+        stream >> ghosts.x[i] >> ghosts.y[i] >> ghosts.direction[i] >> ghosts.state[i];
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+    // The Ghosts are drawn from the read coordinates
+    ghosts.previousX = ghosts.x;
+    ghosts.previousY = ghosts.y;
+
+    m_random.setState(random);
+    m_tick = tick;
+    m_lives = lives;
+    m_points = points;
+    m_level = level;
+    m_nbEatenGhosts = nbEatenGhosts;
+    m_timeouts = timeouts;
+    m_kapman = kapman;
+    m_ghostSpeed = ghostSpeed;
+    m_ghosts = ghosts;
+    m_nbElem = remaining.count(true);
+    int elem = 0;
+    for (int i = 0; i < m_consumables.size(); ++i) {
+        if (m_maze->getConsumable(i) != Maze::NO_CONSUMABLE) {
+            m_consumables[i] = remaining.testBit(elem++) ? m_maze->getConsumable(i) : Maze::NO_CONSUMABLE;
+        }
+    }
+    m_events.clear();
+    return true;
+}
+
+int GameState::getSnapshotSize() const
+{
+    return sizeof(SnapshotHeader) + getNbGhosts() * GHOST_SNAPSHOT_SIZE + m_consumables.size()
+           + m_timeouts.getSnapshotSize();
+}
+
+void GameState::saveSnapshot(char *p_data) const
+{
+    SnapshotHeader header;
+    header.random = m_random.getState();
+    header.points = m_points;
+    header.tick = m_tick;
+    header.lives = m_lives;
+    header.level = m_level;
+    header.nbEatenGhosts = m_nbEatenGhosts;
+    header.nbElem = m_nbElem;
+    header.nbGhosts = getNbGhosts();
+    header.nbCells = m_consumables.size();
+    header.kapman = m_kapman;
+    header.ghostSpeed = m_ghostSpeed;
+
+    // Every part is plain data stored contiguously : the copy is a few memcpy
+    memcpy(p_data, &header, sizeof(header));
+    p_data += sizeof(header);
+    saveArray(p_data, m_ghosts.x);
+    saveArray(p_data, m_ghosts.y);
+    saveArray(p_data, m_ghosts.previousX);
+    saveArray(p_data, m_ghosts.previousY);
+    saveArray(p_data, m_ghosts.direction);
+    saveArray(p_data, m_ghosts.state);
+    saveArray(p_data, m_consumables);
+    m_timeouts.saveSnapshot(p_data);
+}
+
+int GameState::restoreSnapshot(const char *p_data, const int p_size)
+{
+    SnapshotHeader header;
+    const int size = sizeof(header) + getNbGhosts() * GHOST_SNAPSHOT_SIZE + m_consumables.size();
+
+    if (p_size < size) {
+        return 0;
+    }
+    memcpy(&header, p_data, sizeof(header));
+    if (header.nbGhosts != getNbGhosts() || header.nbCells != m_consumables.size()) {
+        return 0;
+    }
+    const int timeoutsSize = m_timeouts.restoreSnapshot(p_data + size, p_size - size);
+    if (timeoutsSize == 0) {
+        return 0;
+    }
+    m_random.setState(header.random);
+    m_points = header.points;
+    m_tick = header.tick;
+    m_lives = header.lives;
+    m_level = header.level;
+    m_nbEatenGhosts = header.nbEatenGhosts;
+    m_nbElem = header.nbElem;
+    m_kapman = header.kapman;
+    m_ghostSpeed = header.ghostSpeed;
+    p_data += sizeof(header);
+    restoreArray(p_data, m_ghosts.x);
+    restoreArray(p_data, m_ghosts.y);
+    restoreArray(p_data, m_ghosts.previousX);
+    restoreArray(p_data, m_ghosts.previousY);
+    restoreArray(p_data, m_ghosts.direction);
+    restoreArray(p_data, m_ghosts.state);
+    restoreArray(p_data, m_consumables);
+    m_events.clear();
+    return size + timeoutsSize;
+}
+
+const QVector<GameState::Event> &GameState::getEvents() const
+{
+    return m_events;
+}
+
+const GameState::KapmanData &GameState::getKapman() const
+{
+    return m_kapman;
+}
+
+int GameState::getNbGhosts() const
+{
+    return m_ghosts.x.size();
+}
+
+GameState::GhostData GameState::getGhost(const int p_ghost) const
+{
+    GhostData ghost;
+    static_cast<SpeedData &>(ghost) = m_ghostSpeed;
+    ghost.xInit = m_ghosts.xInit[p_ghost];
+    ghost.yInit = m_ghosts.yInit[p_ghost];
+    ghost.x = m_ghosts.x[p_ghost];
+    ghost.y = m_ghosts.y[p_ghost];
+    ghost.previousX = m_ghosts.previousX[p_ghost];
+    ghost.previousY = m_ghosts.previousY[p_ghost];
+    ghost.direction = Maze::Direction(m_ghosts.direction[p_ghost]);
+    ghost.state = GhostState(m_ghosts.state[p_ghost]);
+    ghost.speed = getGhostSpeed(ghost.state);
+    return ghost;
+}
+
+int GameState::getBonusX() const
+{
+    return m_bonusX;
+}
+
+int GameState::getBonusY() const
+{
+    return m_bonusY;
+}
+
+bool GameState::isBonusVisible() const
+{
+    return m_timeouts.getRemainingTicks(BONUS_TIMEOUT) > 0;
+}
+
+int GameState::getPreyTicks() const
+{
+    return m_timeouts.getRemainingTicks(PREY_TIMEOUT);
+}
+
+int GameState::getPreyDuration() const
+{
+    return getTicks(PREY_STATE_DURATION);
+}
+
+int GameState::getBonusPoints() const
+{
+    return m_level * 100;
+}
+
+Maze::Consumable GameState::getConsumable(const int p_index) const
+{
+    return (Maze::Consumable)m_consumables[p_index];
+}
+
+int GameState::getNbElem() const
+{
+    return m_nbElem;
+}
+
+GameState::Difficulty GameState::getDifficulty() const
+{
+    return m_difficulty;
+}
+
+int GameState::getTick() const
+{
+    return m_tick;
+}
+
+quint64 GameState::getSeed() const
+{
+    return m_seed;
+}
+
+long GameState::getScore() const
+{
+    return m_points;
+}
+
+int GameState::getLives() const
+{
+    return m_lives;
+}
+
+int GameState::getLevel() const
+{
+    return m_level;
+}
+
+void GameState::initSpeed(SpeedData &p_speed, const int p_maxSpeedPercent, const int p_speedIncreasePercent) const
+{
+    switch (m_difficulty) {
+    case EASY:
+        p_speed.normalSpeed = LOW_SPEED << SPEED_FRACTION_BITS;
+        p_speed.speedIncrease = LOW_SPEED_INC * p_speedIncreasePercent / 100;
+        break;
+    case MEDIUM:
+        p_speed.normalSpeed = MEDIUM_SPEED << SPEED_FRACTION_BITS;
+        p_speed.speedIncrease = MEDIUM_SPEED_INC * p_speedIncreasePercent / 100;
+        break;
+    case HARD:
+        p_speed.normalSpeed = HIGH_SPEED << SPEED_FRACTION_BITS;
+        p_speed.speedIncrease = HIGH_SPEED_INC * p_speedIncreasePercent / 100;
+        break;
+    }
+    p_speed.maxSpeed = p_speed.normalSpeed * p_maxSpeedPercent / 100;
+}
+
+void GameState::increaseSpeed(SpeedData &p_speed)
+{
+    p_speed.normalSpeed += p_speed.normalSpeed * p_speed.speedIncrease / 10000;
+    // Do not have a speed over the max allowed speed
+    if (p_speed.normalSpeed > p_speed.maxSpeed) {
+        p_speed.normalSpeed = p_speed.maxSpeed;
+    }
+}
+
+void GameState::initLevel(const int p_nbLevels)
+{
+    resetConsumables();
+    for (int i = 0; i < p_nbLevels; ++i) {
+        increaseSpeed(m_kapman);
+        increaseSpeed(m_ghostSpeed);
+    }
+    initCharacters();
+}
+
+int GameState::getTicks(const int p_duration) const
+{
+    // The duration is multiplied by the ratio of the medium speed to the Ghosts speed, rounded to the nearest tick
+    const qint64 speed = getNbGhosts() == 0 ? MEDIUM_SPEED << SPEED_FRACTION_BITS : m_ghostSpeed.normalSpeed;
+    const qint64 numerator = qint64(p_duration) * TICKS_PER_SECOND * (MEDIUM_SPEED << SPEED_FRACTION_BITS);
+    const qint64 denominator = speed * 1000;
+    return int((2 * numerator + denominator) / (2 * denominator));
+}
+
+void GameState::addEvent(const EventType p_type, const int p_index, const long p_points)
+{
+    Event event;
+    event.type = p_type;
+    event.index = p_index;
+    event.points = p_points;
+    m_events.append(event);
+}
+
+void GameState::winPoints(const long p_points)
+{
+    m_points += p_points;
+    // For each 10000 points we get a life more
+    if (m_points / 10000 > (m_points - p_points) / 10000) {
+        ++m_lives;
+        addEvent(LIFE_WON);
+    }
+}
+
+int GameState::getGhostSpeed(const GhostState p_state) const
+{
+    return roundSpeed(p_state == PREY ? m_ghostSpeed.normalSpeed / 2 : m_ghostSpeed.normalSpeed);
+}
+
+void GameState::updateKapman()
+{
+    KapmanData &kapman = m_kapman;
+    const Maze::Direction direction = kapman.direction;
+    const Maze::Direction asked = kapman.askedDirection;
+    // The directions the kapman can take from its current cell
+    const int exits = m_maze->getExits(m_maze->getRowFromY(kapman.y), m_maze->getColFromX(kapman.x));
+
+    // If the kapman does not move
+    if (direction == Maze::NONE) {
+        // If the user asks for moving and the next cell in that direction is accessible
+        if (asked != Maze::NONE && (exits & asked)) {
+            kapman.direction = asked;
+            kapman.askedDirection = Maze::NONE;
+            move(kapman);
+        }
+    }
+    // If the kapman wants to go back it does not wait to be on a center
+    else if (asked != Maze::NONE && asked == Maze::getOppositeDirection(direction)) {
+        kapman.direction = asked;
+        kapman.askedDirection = Maze::NONE;
+        // If the kapman just turned at a corner and instantly makes a half-turn, do not run into a wall
+        if (isOnCenter(kapman.x, kapman.y) && !(exits & asked)) {
+            kapman.direction = Maze::NONE;
+        } else {
+            move(kapman);
+        }
+    }
+    // If the kapman gets on a cell center
+    else if (onCenter(kapman.x, kapman.y, kapman.direction, kapman.speed)) {
+        // If there is an asked direction (not a half-turn) and the corresponding next cell is accessible
+        if (asked != Maze::NONE && asked != direction && (exits & asked)) {
+            moveOnCenter(kapman.x, kapman.y);
+            kapman.direction = asked;
+            kapman.askedDirection = Maze::NONE;
+        }
+        // Stop in front of a wall
+        else if (!(exits & direction)) {
+            moveOnCenter(kapman.x, kapman.y);
+            kapman.direction = Maze::NONE;
+            kapman.askedDirection = Maze::NONE;
+        } else {
+            move(kapman);
+        }
+    } else {
+        move(kapman);
+    }
+}
+
+void GameState::updateGhosts()
+{
+    const int nbGhosts = getNbGhosts();
+    // Every array is detached before its items are pointed to, as changing one of a shared array would move them
+    qint32 *x = m_ghosts.x.data();
+    qint32 *y = m_ghosts.y.data();
+    quint8 *direction = m_ghosts.direction.data();
+    const quint8 *state = m_ghosts.state.data();
+    quint8 *onCenters = m_ghostMarks.data();
+    const int hunterSpeed = getGhostSpeed(HUNTER);
+    const int preySpeed = getGhostSpeed(PREY);
+
+    // Mark the Ghosts which get on a Cell center, without branching so that the loop can be vectorized
+    for (int i = 0; i < nbGhosts; ++i) {
+        onCenters[i] = onCenter(x[i], y[i], direction[i], state[i] == PREY ? preySpeed : hunterSpeed);
+    }
+
+    // Only those can change their Direction, the ones which see the Kapman going after it
+    const int kapmanRow = Maze::getRowFromY(m_kapman.y);
+    const int kapmanColumn = Maze::getColFromX(m_kapman.x);
+    for (int i = 0; i < nbGhosts; ++i) {
+        if (!onCenters[i]) {
+            continue;
+        }
+        if (state[i] == HUNTER
+            && m_maze->isInLineSight(Maze::getRowFromY(y[i]), Maze::getColFromX(x[i]), Maze::Direction(direction[i]), kapmanRow, kapmanColumn)) {
+            updateGhost(i, kapmanRow, kapmanColumn);
+        } else {
+            updateGhost(i);
+        }
+    }
+
+    // Move all the Ghosts at the speed of their state, which may have just changed
+    for (int i = 0; i < nbGhosts; ++i) {
+        int dx, dy;
+        getMove(direction[i], state[i] == PREY ? preySpeed : hunterSpeed, dx, dy);
+        x[i] += dx;
+        y[i] += dy;
+    }
+    for (int i = 0; i < nbGhosts; ++i) {
+        takePortal(x[i], y[i], direction[i], state[i] == PREY ? preySpeed : hunterSpeed);
+    }
+}
+
+void GameState::updateGhost(const int p_ghost)
+{
+    qint32 &x = m_ghosts.x[p_ghost];
+    qint32 &y = m_ghosts.y[p_ghost];
+    quint8 &direction = m_ghosts.direction[p_ghost];
+    quint8 &state = m_ghosts.state[p_ghost];
+    // Get the current cell coordinates from the ghost coordinates
+    const int curCellRow = Maze::getRowFromY(y);
+    const int curCellCol = Maze::getColFromX(x);
+
+    // If the ghost is not "eaten"
+    if (state != EATEN) {
+        // The directions the ghost can choose, in the order they are proposed
+        static const Maze::Direction directions[4] = {Maze::RIGHT, Maze::DOWN, Maze::UP, Maze::LEFT};
+        // The directions the ghost can take from the cell, save the turning back
+        const int exits = m_maze->getGhostExits(curCellRow, curCellCol) & ~Maze::getOppositeDirection(Maze::Direction(direction));
+        Maze::Direction choices[4];
+        int nbChoices = 0;
+        for (int i = 0; i < 4; ++i) {
+            if (exits & directions[i]) {
+                choices[nbChoices++] = directions[i];
+            }
+        }
+        // If there is no possible direction, the ghost goes backward
+        if (nbChoices == 0) {
+            direction = Maze::getOppositeDirection(Maze::Direction(direction));
+        } else {
+            // Random number generation to choose one of the directions
+            int nb = 0;
+            if (nbChoices > 1) {
+                nb = m_random.bounded(nbChoices);
+            }
+            // If the chosen direction isn't forward, move the ghost on the center of the cell
+            if (direction != Maze::NONE && direction != choices[nb]) {
+                moveOnCenter(x, y);
+            }
+            direction = choices[nb];
+        }
+    } else {
+        const QPoint camp = m_maze->getResurrectionCell();
+        // If the ghost has reached the camp
+        if (curCellRow == camp.y() && curCellCol == camp.x()) {
+            state = HUNTER;
+        } else {
+            // Get the next move to the camp from the precomputed directions
+            const Maze::Direction campDirection = m_maze->getDirectionToGhostCamp(curCellRow, curCellCol);
+            if (campDirection == Maze::NONE) {
+                // The camp cannot be reached : set the ghost at home
+                x = (camp.x() << Cell::SUBCELL_BITS) | Cell::CENTER;
+                y = (camp.y() << Cell::SUBCELL_BITS) | Cell::CENTER;
+                state = HUNTER;
+            } else if (campDirection != direction) {
+                // We move the ghost on the center of the cell before it turns
+                moveOnCenter(x, y);
+                direction = campDirection;
+            }
+        }
+    }
+}
+
+void GameState::updateGhost(const int p_ghost, const int p_row, const int p_column)
+{
+    quint8 &ghostDirection = m_ghosts.direction[p_ghost];
+    const int curGhostRow = Maze::getRowFromY(m_ghosts.y[p_ghost]);
+    const int curGhostCol = Maze::getColFromX(m_ghosts.x[p_ghost]);
+    Maze::Direction direction;
+    if (curGhostRow == p_row) {
+        direction = p_column > curGhostCol ? Maze::RIGHT : Maze::LEFT;
+    } else {
+        direction = p_row > curGhostRow ? Maze::DOWN : Maze::UP;
+    }
+    // When the target has been seen through a portal, it is ahead even though it looks behind
+    if (direction == Maze::getOppositeDirection(Maze::Direction(ghostDirection))) {
+        direction = Maze::Direction(ghostDirection);
+    }
+    ghostDirection = direction;
+}
+
+void GameState::handleCollisions()
+{
+    // The pill or energizer of the Kapman Cell
+    const int index = m_maze->getCellIndex(m_maze->getRowFromY(m_kapman.y), m_maze->getColFromX(m_kapman.x));
+    const quint8 consumable = m_consumables[index];
+    if (consumable != Maze::NO_CONSUMABLE) {
+        m_consumables[index] = Maze::NO_CONSUMABLE;
+        --m_nbElem;
+        if (consumable == Maze::ENERGIZER) {
+            addEvent(ENERGIZER_EATEN, index, ENERGIZER_POINTS);
+            winPoints(ENERGIZER_POINTS);
+            // The ghosts become preys
+            m_timeouts.remove(PREY_TIMEOUT);
+            m_timeouts.add(PREY_TIMEOUT, getTicks(PREY_STATE_DURATION));
+            quint8 *state = m_ghosts.state.data();
+            const int nbGhosts = m_ghosts.state.size();
+            for (int i = 0; i < nbGhosts; ++i) {
+                state[i] = state[i] == EATEN ? quint8(EATEN) : quint8(PREY);
+            }
+            m_nbEatenGhosts = 0;
+        } else {
+            addEvent(PILL_EATEN, index, PILL_POINTS);
+            winPoints(PILL_POINTS);
+        }
+        if (m_nbElem == 0) {
+            addEvent(LEVEL_COMPLETED);
+            nextLevel();
+            return;
+        }
+        // If 1/3 or 2/3 of the pills are eaten, display the Bonus
+        if (m_nbElem == m_maze->getTotalNbElem() / 3 || m_nbElem == m_maze->getTotalNbElem() * 2 / 3) {
+            m_timeouts.remove(BONUS_TIMEOUT);
+            m_timeouts.add(BONUS_TIMEOUT, getTicks(BONUS_DURATION));
+            addEvent(BONUS_ON);
+        }
+    }
+
+    // The Bonus
+    if (isBonusVisible() && isHit(m_kapman.x, m_kapman.y, m_bonusX, m_bonusY)) {
+        m_timeouts.remove(BONUS_TIMEOUT);
+        addEvent(BONUS_EATEN, -1, getBonusPoints());
+        winPoints(getBonusPoints());
+    }
+
+    // Mark the Ghosts the Kapman touches, without branching so that the loop can be vectorized
+    const int nbGhosts = getNbGhosts();
+    const int kapmanX = m_kapman.x;
+    const int kapmanY = m_kapman.y;
+    const qint32 *x = m_ghosts.x.constData();
+    const qint32 *y = m_ghosts.y.constData();
+    quint8 *hits = m_ghostMarks.data();
+    for (int i = 0; i < nbGhosts; ++i) {
+        hits[i] = isHit(kapmanX, kapmanY, x[i], y[i]);
+    }
+
+    // The Ghosts
+    for (int i = 0; i < nbGhosts; ++i) {
+        if (!hits[i]) {
+            continue;
+        }
+        switch (GhostState(m_ghosts.state[i])) {
+        case HUNTER:
+            --m_lives;
+            addEvent(KAPMAN_DEATH, i);
+            return;
+        case PREY:
+            // Win 200 * number of eaten ghosts since the energizer was eaten
+            ++m_nbEatenGhosts;
+            m_ghosts.state[i] = EATEN;
+            addEvent(GHOST_EATEN, i, GHOST_POINTS * m_nbEatenGhosts);
+            winPoints(GHOST_POINTS * m_nbEatenGhosts);
+            break;
+        case EATEN:
+            // Do nothing
+            break;
+        }
+    }
+}
+
+void GameState::move(CharacterData &p_character) const
+{
+    int dx, dy;
+    quint8 direction = p_character.direction;
+
+    getMove(direction, p_character.speed, dx, dy);
+    p_character.x += dx;
+    p_character.y += dy;
+    takePortal(p_character.x, p_character.y, direction, p_character.speed);
+    p_character.direction = Maze::Direction(direction);
+}
+
+void GameState::takePortal(qint32 &p_x, qint32 &p_y, quint8 &p_direction, const int p_speed) const
+{
+    // A character entering a portal comes out at the other end
+    const int row = Maze::getRowFromY(p_y);
+    const int column = Maze::getColFromX(p_x);
+    const int portalExit = m_maze->getPortalExit(row, column);
+    if (portalExit != -1) {
+        int dx, dy;
+        p_direction = m_maze->getPortalDirection(row, column);
+        getMove(p_direction, p_speed, dx, dy);
+        p_x = ((m_maze->getColumnFromIndex(portalExit) << Cell::SUBCELL_BITS) | Cell::CENTER) + dx;
+        p_y = ((m_maze->getRowFromIndex(portalExit) << Cell::SUBCELL_BITS) | Cell::CENTER) + dy;
+    }
+}
+
+bool GameState::onCenter(const int p_x, const int p_y, const int p_direction, const int p_speed)
+{
+    // The coordinates inside the current cell, along the direction and across it
+    const bool vertical = p_direction & (Maze::UP | Maze::DOWN);
+    const int along = (vertical ? p_y : p_x) & Cell::SUBCELL_MASK;
+    const int across = (vertical ? p_x : p_y) & Cell::SUBCELL_MASK;
+    // The offsets the character can be at before the center and still go past it
+    const int first = Cell::CENTER - ((p_direction & (Maze::RIGHT | Maze::DOWN)) ? p_speed : 0);
+    const int last = Cell::CENTER + ((p_direction & (Maze::LEFT | Maze::UP)) ? p_speed : 0);
+
+    // Will the character go past the center of the cell it's on ? If it does not move, is it on the center ?
+    return along >= first && along <= last && (p_direction != Maze::NONE || across == Cell::CENTER);
+}
+
+bool GameState::isOnCenter(const int p_x, const int p_y)
+{
+    return (p_x & Cell::SUBCELL_MASK) == Cell::CENTER && (p_y & Cell::SUBCELL_MASK) == Cell::CENTER;
+}
+
+void GameState::moveOnCenter(qint32 &p_x, qint32 &p_y)
+{
+    p_x = (p_x & ~Cell::SUBCELL_MASK) | Cell::CENTER;
+    p_y = (p_y & ~Cell::SUBCELL_MASK) | Cell::CENTER;
+}
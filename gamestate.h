@@ -0,0 +1,600 @@
+/*
+ * Copyright 2007-2008 Thomas Gallinari <tg8187@yahoo.fr>
+ * Copyright 2007-2008 Pierre-Benoît Besse <besse.pb@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GAMESTATE_H
+#define GAMESTATE_H
+
+#include "maze.h"
+#include "randomgenerator.h"
+#include "timingwheel.h"
+
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * @brief This class holds the whole state of a game and advances it tick by tick.
+ *
+ * It moves the characters, handles the collisions between them and with the pills, energizers and bonus,
+ * and keeps the score, the lives, the level and the timers counted in ticks.
+ * It is a plain class with no signal : each call to step() gives the same result for the same state and input,
+ * the random choices of the Ghosts being drawn from a generator of its own, and reports what happened during the tick as a list of events the Qt classes turn into signals.
+ * The coordinates are fixed-point integers in Cell::SUBCELLS units per Cell and the speeds integers too,
+ * so that a game gives the same result whatever the compiler and the processor.
+ */
+class GameState
+{
+
+public:
+
+    /** The number of ticks per second */
+    static const int TICKS_PER_SECOND;
+
+    /** The number of bits of the fraction of the speeds which only change with the levels, see CharacterData */
+    static const int SPEED_FRACTION_BITS;
+
+    /** Speed on easy level, in Cell::SUBCELLS units per Cell and per tick */
+    static const int LOW_SPEED;
+
+    /** Speed on medium level, in Cell::SUBCELLS units per Cell and per tick */
+    static const int MEDIUM_SPEED;
+
+    /** Speed on hard level, in Cell::SUBCELLS units per Cell and per tick */
+    static const int HIGH_SPEED;
+
+    /** Speed increase on easy level, in parts per ten thousand */
+    static const int LOW_SPEED_INC;
+
+    /** Speed increase on medium level, in parts per ten thousand */
+    static const int MEDIUM_SPEED_INC;
+
+    /** Speed increase on hard level, in parts per ten thousand */
+    static const int HIGH_SPEED_INC;
+
+    /** Duration of the prey state in medium difficulty, in milliseconds */
+    static const int PREY_STATE_DURATION;
+
+    /** Duration of the bonus apparition in medium difficulty, in milliseconds */
+    static const int BONUS_DURATION;
+
+    /** The game difficulty levels */
+    enum Difficulty {
+        EASY = 0,
+        MEDIUM = 1,
+        HARD = 2
+    };
+
+    /** The Ghost possible states */
+    enum GhostState {
+        HUNTER = 0,
+        PREY = 1,
+        EATEN = 2
+    };
+
+    /** The things that can happen during a tick */
+    enum EventType {
+        PILL_EATEN,         // The index is the Cell of the pill
+        ENERGIZER_EATEN,    // The index is the Cell of the energizer
+        GHOST_EATEN,        // The index is the Ghost number
+        BONUS_EATEN,
+        BONUS_ON,
+        BONUS_OFF,
+        LIFE_WON,
+        KAPMAN_DEATH,       // The index is the number of the Ghost which has caught the Kapman
+        LEVEL_COMPLETED
+    };
+
+    /** Something that has happened during a tick, the events of the last tick being given by getEvents() */
+    struct Event {
+        /** The event type */
+        EventType type;
+        /** The Cell index or the Ghost number the event is about, -1 if none */
+        int index;
+        /** The points won with the event */
+        long points;
+    };
+
+    /**
+     * The speeds of a character which change with the levels.
+     * They have SPEED_FRACTION_BITS more bits than the speeds the characters move at, so that the small increases of each level add up.
+     */
+    struct SpeedData {
+        /** The speed when in "normal" behaviour */
+        qint32 normalSpeed;
+        /** The part the normal speed is increased by when level up, in parts per ten thousand */
+        qint32 speedIncrease;
+        /** The maximum normal speed */
+        qint32 maxSpeed;
+    };
+
+    /**
+     * The state of a character.
+     * The coordinates are in Cell::SUBCELLS units per Cell, and the speed in units per tick.
+     */
+    struct CharacterData : SpeedData {
+        /** The initial x-coordinate */
+        qint32 xInit;
+        /** The initial y-coordinate */
+        qint32 yInit;
+        /** The current x-coordinate */
+        qint32 x;
+        /** The current y-coordinate */
+        qint32 y;
+        /** The x-coordinate before the last tick */
+        qint32 previousX;
+        /** The y-coordinate before the last tick */
+        qint32 previousY;
+        /** The Direction the character moves to, Maze::NONE if it does not move */
+        Maze::Direction direction;
+        /** The speed */
+        qint32 speed;
+    };
+
+    /** The state of the Kapman */
+    struct KapmanData : CharacterData {
+        /** The Direction the player has asked for, Maze::NONE if none */
+        Maze::Direction askedDirection;
+    };
+
+    /** The state of a Ghost */
+    struct GhostData : CharacterData {
+        /** The Ghost state */
+        GhostState state;
+    };
+
+private:
+
+    /** The timeouts of the game */
+    enum Timeout {
+        PREY_TIMEOUT,       // The Ghosts stop being preys
+        BONUS_TIMEOUT       // The Bonus disappears
+    };
+
+    /**
+     * The Ghosts, stored as one array per property rather than one GhostData per Ghost.
+     * Each pass of a tick goes through the few properties it needs for all the Ghosts at once,
+     * and the Ghosts speeds, the same for all of them, are kept apart.
+     */
+    struct GhostArrays {
+        /** The initial x-coordinates */
+        QVector<qint32> xInit;
+        /** The initial y-coordinates */
+        QVector<qint32> yInit;
+        /** The current x-coordinates */
+        QVector<qint32> x;
+        /** The current y-coordinates */
+        QVector<qint32> y;
+        /** The x-coordinates before the last tick */
+        QVector<qint32> previousX;
+        /** The y-coordinates before the last tick */
+        QVector<qint32> previousY;
+        /** The Maze::Direction each Ghost moves to */
+        QVector<quint8> direction;
+        /** The GhostState of each Ghost */
+        QVector<quint8> state;
+    };
+
+    /** The plain data a snapshot starts with, followed by the Ghosts arrays, the things left to eat and the timeouts */
+    struct SnapshotHeader {
+        /** The random-number generator state */
+        quint64 random;
+        /** The score */
+        qint64 points;
+        /** The number of ticks run */
+        qint32 tick;
+        /** The remaining number of lives */
+        qint32 lives;
+        /** The current level */
+        qint32 level;
+        /** The number of Ghosts eaten since the last Energizer */
+        qint32 nbEatenGhosts;
+        /** The number of things left to eat */
+        qint32 nbElem;
+        /** The number of Ghosts */
+        qint32 nbGhosts;
+        /** The number of Cells */
+        qint32 nbCells;
+        /** The Kapman */
+        KapmanData kapman;
+        /** The Ghosts speeds */
+        SpeedData ghostSpeed;
+    };
+
+    /** The Maze the game is played on */
+    const Maze *m_maze;
+
+    /** The game difficulty */
+    Difficulty m_difficulty;
+
+    /** The seed the random-number generator has been started from */
+    quint64 m_seed;
+
+    /** The random-number generator the Ghosts choose their way with */
+    RandomGenerator m_random;
+
+    /** The number of ticks run since the beginning of the game */
+    int m_tick;
+
+    /** The Kapman */
+    KapmanData m_kapman;
+
+    /** The Ghosts */
+    GhostArrays m_ghosts;
+
+    /** The speeds of the Ghosts, the same for all of them */
+    SpeedData m_ghostSpeed;
+
+    /** For each Ghost, whether it gets on a Cell center or touches the Kapman during the current tick */
+    QVector<quint8> m_ghostMarks;
+
+    /** The Bonus x-coordinate */
+    qint32 m_bonusX;
+
+    /** The Bonus y-coordinate */
+    qint32 m_bonusY;
+
+    /** The timeouts, which expire as the ticks are run */
+    TimingWheel m_timeouts;
+
+    /**
+     * For each Cell, the Maze::Consumable it still holds, copied from the Maze at the beginning of a level.
+     * The tick a Cell has been eaten at is not kept : it is the tick of its PILL_EATEN or ENERGIZER_EATEN event.
+     */
+    QVector<quint8> m_consumables;
+
+    /** The number of things left to eat */
+    int m_nbElem;
+
+    /** The remaining number of lives */
+    int m_lives;
+
+    /** The won points */
+    long m_points;
+
+    /** The current game level */
+    int m_level;
+
+    /** The number of eaten ghosts since the last energizer was eaten */
+    int m_nbEatenGhosts;
+
+    /** The events of the last tick */
+    QVector<Event> m_events;
+
+public:
+
+    /**
+     * Creates a new GameState instance.
+     * @param p_maze the Maze the game is played on
+     * @param p_difficulty the game difficulty
+     * @param p_seed the seed of the random-number generator
+     */
+    GameState(const Maze *p_maze, const Difficulty p_difficulty, const quint64 p_seed);
+
+    /**
+     * Deletes the GameState instance.
+     */
+    ~GameState();
+
+    /**
+     * Sets the Kapman initial coordinates.
+     * @param p_x the initial x-coordinate, in Cell::SUBCELLS units per Cell
+     * @param p_y the initial y-coordinate, in Cell::SUBCELLS units per Cell
+     */
+    void setKapman(const int p_x, const int p_y);
+
+    /**
+     * Adds a Ghost.
+     * @param p_x the initial x-coordinate, in Cell::SUBCELLS units per Cell
+     * @param p_y the initial y-coordinate, in Cell::SUBCELLS units per Cell
+     */
+    void addGhost(const int p_x, const int p_y);
+
+    /**
+     * Sets the Bonus coordinates.
+     * @param p_x the x-coordinate, in Cell::SUBCELLS units per Cell
+     * @param p_y the y-coordinate, in Cell::SUBCELLS units per Cell
+     */
+    void setBonus(const int p_x, const int p_y);
+
+    /**
+     * Puts back on each Cell the thing it holds at the beginning of a level, once the Maze has been filled.
+     */
+    void resetConsumables();
+
+    /**
+     * Starts the random-number generator from another seed, before the first tick.
+     * @param p_seed the seed
+     */
+    void setSeed(const quint64 p_seed);
+
+    /**
+     * Moves the characters to their initial coordinates, the Ghosts being hunters.
+     */
+    void initCharacters();
+
+    /**
+     * Advances the game by one tick, the coordinates before the tick being kept to draw the characters between two ticks.
+     * @param p_input the Direction the player has asked for since the last tick, Maze::NONE if none
+     */
+    void step(const Maze::Direction p_input);
+
+    /**
+     * Starts the next level : the Maze is filled again and the characters are faster.
+     */
+    void nextLevel();
+
+    /**
+     * Sets the level to the given number.
+     * @param p_level the new level
+     */
+    void setLevel(const int p_level);
+
+    /**
+     * Gives one more life.
+     */
+    void addLife();
+
+    /**
+     * Saves the part of the state that changes while playing, so that the game can go on from it later.
+     * @return the saved state
+     */
+    QByteArray saveState() const;
+
+    /**
+     * Restores a state saved by a GameState of the same game.
+     * @param p_state the saved state
+     * @return true if the state has been restored, false if it is not valid for this game
+     */
+    bool restoreState(const QByteArray &p_state);
+
+    /**
+     * @return the number of bytes of a snapshot of the state
+     */
+    int getSnapshotSize() const;
+
+    /**
+     * Copies the part of the state that changes while playing as plain data, to restore it quickly.
+     * Unlike saveState(), the copy is not compact and only fits the GameState of the same game in the same program.
+     * @param p_data the memory to copy to, of getSnapshotSize() bytes
+     */
+    void saveSnapshot(char *p_data) const;
+
+    /**
+     * Restores a snapshot of the state.
+     * @param p_data the memory holding the snapshot
+     * @param p_size the number of bytes that can be read
+     * @return the number of bytes of the snapshot, 0 if it is not valid for this game
+     */
+    int restoreSnapshot(const char *p_data, const int p_size);
+
+    /**
+     * Gets the events of the last tick.
+     * @return the events in the order they have happened
+     */
+    const QVector<Event> &getEvents() const;
+
+    /**
+     * @return the Kapman state
+     */
+    const KapmanData &getKapman() const;
+
+    /**
+     * @return the number of Ghosts
+     */
+    int getNbGhosts() const;
+
+    /**
+     * Gathers the state of a Ghost from the Ghosts arrays.
+     * @param p_ghost the Ghost number
+     * @return the Ghost state
+     */
+    GhostData getGhost(const int p_ghost) const;
+
+    /**
+     * @return the Bonus x-coordinate, in Cell::SUBCELLS units per Cell
+     */
+    int getBonusX() const;
+
+    /**
+     * @return the Bonus y-coordinate, in Cell::SUBCELLS units per Cell
+     */
+    int getBonusY() const;
+
+    /**
+     * @return true if the Bonus is displayed
+     */
+    bool isBonusVisible() const;
+
+    /**
+     * @return the number of ticks the Ghosts remain preys, 0 if they are not
+     */
+    int getPreyTicks() const;
+
+    /**
+     * @return the number of ticks the Ghosts remain preys after an Energizer has been eaten, at the current Ghosts speed
+     */
+    int getPreyDuration() const;
+
+    /**
+     * @return the points won by eating the Bonus
+     */
+    int getBonusPoints() const;
+
+    /**
+     * @param p_index the Cell index
+     * @return the thing the Cell still holds
+     */
+    Maze::Consumable getConsumable(const int p_index) const;
+
+    /**
+     * @return the number of things left to eat
+     */
+    int getNbElem() const;
+
+    /**
+     * @return the game difficulty
+     */
+    Difficulty getDifficulty() const;
+
+    /**
+     * @return the number of ticks run since the beginning of the game
+     */
+    int getTick() const;
+
+    /**
+     * @return the seed of the random-number generator, which enables to play the game again
+     */
+    quint64 getSeed() const;
+
+    /**
+     * @return the score
+     */
+    long getScore() const;
+
+    /**
+     * @return the number of remaining lives
+     */
+    int getLives() const;
+
+    /**
+     * @return the current level
+     */
+    int getLevel() const;
+
+    /**
+     * Checks a character gets on a Cell center during its next movement.
+     * @param p_x the x-coordinate of the character
+     * @param p_y the y-coordinate of the character
+     * @param p_direction the Direction of the character
+     * @param p_speed the speed of the character
+     * @return true if the character is on a Cell center, false otherwise
+     */
+    static bool onCenter(const int p_x, const int p_y, const int p_direction, const int p_speed);
+
+    /**
+     * Checks whether a character is currently on a Cell center.
+     * @param p_x the x-coordinate of the character
+     * @param p_y the y-coordinate of the character
+     * @return true if the character is on a Cell center, false otherwise
+     */
+    static bool isOnCenter(const int p_x, const int p_y);
+
+private:
+
+    /**
+     * Initializes the speeds of a character considering the difficulty level.
+     * @param p_speed the character speeds
+     * @param p_maxSpeedPercent the maximum speed, in percent of the initial speed
+     * @param p_speedIncreasePercent the character speed increase when level up, in percent of the Ghosts one
+     */
+    void initSpeed(SpeedData &p_speed, const int p_maxSpeedPercent, const int p_speedIncreasePercent) const;
+
+    /**
+     * Increases the speed of a character with each level completed.
+     * @param p_speed the character speeds
+     */
+    static void increaseSpeed(SpeedData &p_speed);
+
+    /**
+     * Fills the Maze again and increases the characters speed for the given number of levels.
+     * @param p_nbLevels the number of levels to increase the speed for
+     */
+    void initLevel(const int p_nbLevels);
+
+    /**
+     * Gets the number of ticks a timer lasts.
+     * @param p_duration the timer duration in medium difficulty, in milliseconds
+     * @return the number of ticks, considering the Ghosts speed
+     */
+    int getTicks(const int p_duration) const;
+
+    /**
+     * Records an event of the current tick.
+     * @param p_type the event type
+     * @param p_index the Cell index or the Ghost number the event is about, -1 if none
+     * @param p_points the points won with the event
+     */
+    void addEvent(const EventType p_type, const int p_index = -1, const long p_points = 0);
+
+    /**
+     * Adds points to the score, and gives one more life for each 10000 points.
+     * @param p_points the won points
+     */
+    void winPoints(const long p_points);
+
+    /**
+     * Gets the speed the Ghosts move at in a given state.
+     * @param p_state the Ghost state
+     * @return the speed, in Cell::SUBCELLS units per tick
+     */
+    int getGhostSpeed(const GhostState p_state) const;
+
+    /**
+     * Updates the Kapman move.
+     */
+    void updateKapman();
+
+    /**
+     * Updates the moves of all the Ghosts, those which see the Kapman going after it.
+     * The Ghosts which get on a Cell center are marked first, then only those choose their Direction, and all of them move.
+     */
+    void updateGhosts();
+
+    /**
+     * Chooses the Direction of a Ghost which wanders or goes back to the camp, once on a Cell center.
+     * @param p_ghost the Ghost number
+     */
+    void updateGhost(const int p_ghost);
+
+    /**
+     * Chooses the Direction of a Ghost which chases the Kapman, once on a Cell center.
+     * @param p_ghost the Ghost number
+     * @param p_row the row index of the Kapman Cell
+     * @param p_column the column index of the Kapman Cell
+     */
+    void updateGhost(const int p_ghost, const int p_row, const int p_column);
+
+    /**
+     * Handles the collisions of the Kapman with the things of its Cell, the Bonus and the Ghosts.
+     */
+    void handleCollisions();
+
+    /**
+     * Moves a character function of its current coordinates and speed, through the portals.
+     * @param p_character the character
+     */
+    void move(CharacterData &p_character) const;
+
+    /**
+     * Takes a character which has entered a portal to the other end.
+     * @param p_x the x-coordinate of the character, past its move
+     * @param p_y the y-coordinate of the character, past its move
+     * @param p_direction the Direction of the character
+     * @param p_speed the speed of the character
+     */
+    void takePortal(qint32 &p_x, qint32 &p_y, quint8 &p_direction, const int p_speed) const;
+
+    /**
+     * Moves a character on the center of its current Cell.
+     * @param p_x the x-coordinate of the character
+     * @param p_y the y-coordinate of the character
+     */
+    static void moveOnCenter(qint32 &p_x, qint32 &p_y);
+};
+
+#endif
+
@@ -20,7 +20,6 @@
 #define GHOST_H
 
 #include "character.h"
-#include "kapman.h"
 
 /**
  * @brief This class represents a Ghost for kapman.
@@ -32,30 +31,21 @@ class Ghost : public Character
 
 public:
 
-    /** The ghost possible states */
+    /** The ghost possible states, with the values of GameState::GhostState */
     enum State {
-        HUNTER = 0,
-        PREY = 1,
-        EATEN = 2
+        HUNTER = GameState::HUNTER,
+        PREY = GameState::PREY,
+        EATEN = GameState::EATEN
     };
 
-    /** The value of an Ghost */
-    static const int POINTS;
-
 private:
 
-    /** Max speed ratio, compared with the initial speed  */
-    static const qreal MAX_SPEED_RATIO;
-
     /** The path to the Ghost image */
     QString m_imageId;
 
     /** The ghost current state */
     State m_state;
 
-    /** A list of Cells to go to the camp from the current cell */
-    QList<QPoint> m_pathToCamp;
-
 public:
 
     /**
@@ -73,16 +63,11 @@ public:
     ~Ghost();
 
     /**
-     * Updates the Ghost move.
+     * Updates the Ghost from its state in the GameState.
+     * @param p_data the Ghost state
+     * @return STATE_CHANGED if the Ghost state has changed, NO_CHANGE otherwise
      */
-    void updateMove() Q_DECL_OVERRIDE;
-
-    /**
-     * Updates the Ghost with a direction to follow.
-     * @param p_row x coordinate of the cell to reach
-     * @param p_col y coordinate of the cell to reach
-     */
-    void updateMove(int p_row, int p_col);
+    int update(const GameState::GhostData &p_data);
 
     /**
      * Gets the path to the Ghost image.
@@ -101,57 +86,6 @@ public:
      * @param p_state the new Ghost state
      */
     void setState(Ghost::State p_state);
-
-    /**
-     * Manages the collison with the Kapman.
-     * @param p_kapman the instance of Kapman which collides with the Ghost
-     */
-    void doActionOnCollision(Kapman *p_kapman) Q_DECL_OVERRIDE;
-
-    /**
-     * Initializes the Ghost speed from the Character speed.
-     */
-    void initSpeedInc() Q_DECL_OVERRIDE;
-
-private:
-
-    /**
-     * Makes the Ghost go up.
-     */
-    void goUp() Q_DECL_OVERRIDE;
-
-    /**
-     * Makes the Ghost go down.
-     */
-    void goDown() Q_DECL_OVERRIDE;
-
-    /**
-     * Makes the Ghost go to the right.
-     */
-    void goRight() Q_DECL_OVERRIDE;
-
-    /**
-     * Makes the Ghost go to the left.
-     */
-    void goLeft() Q_DECL_OVERRIDE;
-
-signals:
-
-    /**
-     * Emitted when the Kapman has lost a life.
-     */
-    void lifeLost();
-
-    /**
-     * Emitted when the Ghost has been eaten.
-     * @param p_ghost the eaten Ghost (this)
-     */
-    void ghostEaten(Ghost *p_ghost);
-
-    /**
-     * Emitted when the Ghost has changed his state.
-     */
-    void stateChanged();
 };
 
 #endif
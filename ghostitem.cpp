@@ -17,40 +17,22 @@
  */
 
 #include "ghostitem.h"
-#include "game.h"
 
 GhostItem::GhostItem(Ghost *p_model) : CharacterItem(p_model)
 {
-    connect(p_model, SIGNAL(stateChanged()), this, SLOT(updateState()));
-
-    // Calculations for the duration of blinking stuff
-    int blinkTimerDuration = (int)(500 * Game::s_durationRatio);
-    int startBlinkingTimerDuration = (int)(Game::s_preyStateDuration * Game::s_durationRatio - 5 * blinkTimerDuration);
-
-    // Define the timer which tells the ghosts to start blinking when about to leave prey state
-    m_startBlinkingTimer = new QTimer(this);
-    m_startBlinkingTimer->setInterval(startBlinkingTimerDuration);
-    m_startBlinkingTimer->setSingleShot(true);
-    connect(m_startBlinkingTimer, &QTimer::timeout, this, &GhostItem::startBlinking);
-
-    // Define the timer which sets the blinking frequency
-    m_blinkTimer = new QTimer(this);
-    m_blinkTimer->setInterval(blinkTimerDuration);
-    connect(m_blinkTimer, &QTimer::timeout, this, &GhostItem::blink);
 }
 
 GhostItem::~GhostItem()
 {
-    delete m_startBlinkingTimer;
 }
 
-void GhostItem::updateBlinkTimersDuration()
+void GhostItem::applyChanges(const int p_changes)
 {
-    // Set the timers duration depending on the prey state duration
-    int blinkTimerDuration = (int)((Game::s_preyStateDuration * Game::s_durationRatio) / 20);
-    int startBlinkingTimerDuration = (int)(blinkTimerDuration * 15);
-    m_blinkTimer->setInterval(blinkTimerDuration);
-    m_startBlinkingTimer->setInterval(startBlinkingTimerDuration);
+    // Show the new state before the blinks, which only happen in the prey state
+    if (p_changes & Character::STATE_CHANGED) {
+        updateState();
+    }
+    CharacterItem::applyChanges(p_changes);
 }
 
 void GhostItem::update(qreal p_x, qreal p_y)
@@ -64,18 +46,9 @@ void GhostItem::update(qreal p_x, qreal p_y)
 
 void GhostItem::updateState()
 {
-    // Stop timers
-    if (m_startBlinkingTimer->isActive()) {
-        m_startBlinkingTimer->stop();
-    }
-    if (m_blinkTimer->isActive()) {
-        m_blinkTimer->stop();
-    }
     switch (((Ghost *)getModel())->getState()) {
     case Ghost::PREY:
-        updateBlinkTimersDuration();
         setElementId(QLatin1Literal("scaredghost"));
-        m_startBlinkingTimer->start();
         // The ghosts are now weaker than the kapman, so they are under him
         setZValue(1);
         break;
@@ -95,6 +68,10 @@ void GhostItem::updateState()
 void GhostItem::blink()
 {
     CharacterItem::blink();
+    // The Ghost blinks when it is about to stop being a prey
+    if (((Ghost *)getModel())->getState() != Ghost::PREY) {
+        return;
+    }
     if (m_nbBlinks % 2 == 0) {
         setElementId(QLatin1Literal("scaredghost"));
     } else {
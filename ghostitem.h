@@ -30,11 +30,6 @@ class GhostItem : public CharacterItem
 
     Q_OBJECT
 
-private:
-
-    /** Timer to start the ghosts blinking */
-    QTimer *m_startBlinkingTimer;
-
 public:
 
     /**
@@ -49,9 +44,9 @@ public:
     ~GhostItem();
 
     /**
-     * Ensures the blink timers are correctly set
+     * Implements the CharacterItem method.
      */
-    void updateBlinkTimersDuration();
+    void applyChanges(const int p_changes) Q_DECL_OVERRIDE;
 
 public slots:
 
@@ -28,14 +28,6 @@ class Kapman : public Character
 
     Q_OBJECT
 
-private:
-
-    /** Max speed ratio, compared with the initial speed  */
-    static const qreal MAX_SPEED_RATIO;
-
-    /** Kapman asked speed */
-    qreal m_askedXSpeed, m_askedYSpeed;
-
 public:
 
     /**
@@ -52,105 +44,19 @@ public:
     ~Kapman();
 
     /**
-     * Initializes the Kapman.
-     */
-    void init();
-
-    /**
-     * Makes the Kapman ask to go up
-     */
-    void goUp() Q_DECL_OVERRIDE;
-
-    /**
-     * Makes the Kapman ask to go down
-     */
-    void goDown() Q_DECL_OVERRIDE;
-
-    /**
-     * Makes the Kapman ask to go to the right
-     */
-    void goRight() Q_DECL_OVERRIDE;
-
-    /**
-     * Makes the Kapman ask to go to the left
+     * Initializes the Kapman from its state in the GameState, at the beginning of a level or after a death.
+     * @param p_data the Kapman state
+     * @return the changes to show : the Kapman is shown at its new coordinates, in its new direction and stopped
      */
-    void goLeft() Q_DECL_OVERRIDE;
+    int init(const GameState::CharacterData &p_data);
 
     /**
-     * Updates the Kapman move
+     * Updates the Kapman from its state in the GameState.
+     * @param p_data the Kapman state
+     * @return TURNED or STOPPED if the Kapman has turned or stopped, NO_CHANGE otherwise
      */
-    void updateMove() Q_DECL_OVERRIDE;
-
-    /**
-     * @return the asked x speed value
-     */
-    qreal getAskedXSpeed() const;
-
-    /**
-     * @return the asked y speed value
-     */
-    qreal getAskedYSpeed() const;
-
-    /**
-     * Manages the points won
-     * @param p_element reference to the element eaten
-     */
-    void winPoints(Element *p_element);
-
-    /**
-     * Implements the Character function
-     */
-    void die();
-
-    /**
-     * Emits a signal to Kapmanitem in order to manage collisions
-     */
-    void emitGameUpdated();
-
-    /**
-     * Initializes the Kapman speed from the Character speed.
-     */
-    void initSpeedInc() Q_DECL_OVERRIDE;
-
-private:
-
-    /**
-     * Updates the Kapman direction with the asked direction
-     */
-    void updateDirection();
-
-    /**
-     * @return the next cell the kapman will move on with its asked direction
-     */
-    Cell getAskedNextCell();
-
-    /**
-     * Stops moving the Kapman
-     */
-    void stopMoving();
-
-signals:
-
-    /**
-     * Emitted when the direction changed
-     */
-    void directionChanged();
-
-    /**
-     * Signals to the game that the kapman win points
-     * @param p_element reference to the element eaten
-     */
-    void sWinPoints(Element *p_element);
-
-    /**
-     * Signals to Kapmanitem that the game has been updated
-     */
-    void gameUpdated();
-
-    /**
-     * Emitted when the kapman stops moving
-     */
-    void stopped();
+    int update(const GameState::CharacterData &p_data);
 };
 
 #endif
+
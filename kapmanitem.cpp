@@ -18,10 +18,8 @@
 
 #include "kapmanitem.h"
 #include "characteritem.h"
-#include "ghost.h"
 #include "settings.h"
 
-#include <QGraphicsScene>
 #include <KgDifficulty>
 
 const int KapmanItem::NB_FRAMES = 32;
@@ -31,9 +29,6 @@ const int KapmanItem::ANIM_HIGH_SPEED = 300;
 
 KapmanItem::KapmanItem(Kapman *p_model) : CharacterItem(p_model)
 {
-    connect(p_model, SIGNAL(directionChanged()), this, SLOT(updateDirection()));
-    connect(p_model, SIGNAL(gameUpdated()), this, SLOT(manageCollision()));
-    connect(p_model, SIGNAL(stopped()), this, SLOT(stopAnim()));
 
     // A timeLine for the Kapman animation
     m_animationTimer = new QTimeLine();
@@ -53,11 +48,6 @@ KapmanItem::KapmanItem(Kapman *p_model) : CharacterItem(p_model)
         break;
     }
     connect(m_animationTimer, &QTimeLine::frameChanged, this, &KapmanItem::setFrame);
-
-    // Define the timer which sets the blinking frequency
-    m_blinkTimer = new QTimer(this);
-    m_blinkTimer->setInterval(400);
-    connect(m_blinkTimer, &QTimer::timeout, this, &KapmanItem::blink);
 }
 
 KapmanItem::~KapmanItem()
@@ -65,6 +55,18 @@ KapmanItem::~KapmanItem()
     delete m_animationTimer;
 }
 
+void KapmanItem::applyChanges(const int p_changes)
+{
+    // Turn or stop the Kapman before moving it, as its animation only goes on while it moves
+    if (p_changes & Character::TURNED) {
+        updateDirection();
+    }
+    if (p_changes & Character::STOPPED) {
+        stopAnim();
+    }
+    CharacterItem::applyChanges(p_changes);
+}
+
 void KapmanItem::updateDirection()
 {
     QTransform transform;
@@ -72,15 +74,18 @@ void KapmanItem::updateDirection()
     Kapman *model = (Kapman *)getModel();
 
     // Compute the angle
-    if (model->getXSpeed() > 0) {
-        angle = 0;
-    } else if (model->getXSpeed() < 0) {
+    switch (model->getDirection()) {
+    case Maze::LEFT:
         angle = 180;    // The default image is right oriented
-    }
-    if (model->getYSpeed() > 0) {
+        break;
+    case Maze::DOWN:
         angle = 90;
-    } else if (model->getYSpeed() < 0) {
+        break;
+    case Maze::UP:
         angle = -90;
+        break;
+    default:
+        break;
     }
 
     if (m_rotationFlag == 0) {
@@ -93,31 +98,12 @@ void KapmanItem::updateDirection()
     setTransform(transform);
 }
 
-void KapmanItem::manageCollision()
-{
-    QList<QGraphicsItem *> collidingList = collidingItems();
-
-    // The signal is emitted only if the list contains more than 1 items (to exclude the case
-    // when the kapman only collides with the maze)
-    if (collidingList.size() > 1) {
-        for (int i = 0; i < collidingList.size(); ++i) {
-            // The maze and the points labels have a negative zValue which allows to exclude them from the treatment of collisions
-            if (collidingList[i]->zValue() >= 0) {
-                ElementItem *item = dynamic_cast<ElementItem *>(collidingList[i]);
-                if (item) {
-                    item->getModel()->doActionOnCollision((Kapman *)getModel());
-                }
-            }
-        }
-    }
-}
-
 void KapmanItem::update(qreal p_x, qreal p_y)
 {
     ElementItem::update(p_x, p_y);
 
     // If the kapman is moving
-    if (((Kapman *)getModel())->getXSpeed() != 0 || ((Kapman *)getModel())->getYSpeed() != 0) {
+    if (((Kapman *)getModel())->getDirection() != Maze::NONE) {
         startAnim();
     }
 }
@@ -172,9 +158,5 @@ void KapmanItem::blink()
     } else {
         setElementId(QLatin1Literal("kapman_blink"));
     }
-    // Make the kapman blink 2 times (4 ticks)
-    if (m_nbBlinks == 4) {
-        m_blinkTimer->stop();
-    }
 }
 
@@ -60,6 +60,11 @@ public:
      */
     ~KapmanItem();
 
+    /**
+     * Implements the CharacterItem method.
+     */
+    void applyChanges(const int p_changes) Q_DECL_OVERRIDE;
+
 public slots:
 
     /**
@@ -67,11 +72,6 @@ public slots:
      */
     void updateDirection();
 
-    /**
-     * Manages the collisions with any Element.
-     */
-    void manageCollision();
-
     /**
      * Updates the KapmanItem coordinates.
      * @param p_x the new x-coordinate
@@ -32,18 +32,26 @@
 #include <KgDifficulty>
 #include <KScoreDialog>
 #include <QAction>
+#include <QDateTime>
+#include <QFileDialog>
 #include <QLabel>
 
 #define USE_UNSTABLE_LIBKDEGAMESPRIVATE_API
 #include <libkdegamesprivate/kgamethemeselector.h>
 
-KapmanMainWindow::KapmanMainWindow()
+KapmanMainWindow::KapmanMainWindow(const bool p_isSeeded, const quint64 p_seed, const int p_turboTicks, const bool p_isThreaded) :
+    m_isSeeded(p_isSeeded),
+    m_seed(p_seed),
+    m_turboTicks(p_turboTicks),
+    m_isThreaded(p_isThreaded)
 {
     // Initialize the game
     m_game = NULL;
     m_view = NULL;
     // Set the window menus
     KStandardGameAction::gameNew(this, SLOT(newGame(bool)), actionCollection());
+    KStandardGameAction::load(this, SLOT(loadReplay()), actionCollection());
+    KStandardGameAction::save(this, SLOT(saveReplay()), actionCollection());
     KStandardGameAction::highscores(this, SLOT(showHighscores()), actionCollection());
     KStandardAction::preferences(this, SLOT(showSettings()), actionCollection());
     KStandardGameAction::quit(this, SLOT(close()), actionCollection());
@@ -54,6 +62,9 @@ KapmanMainWindow::KapmanMainWindow()
     QAction *levelAction = new QAction(i18n("&Change level"), this);
     actionCollection()->addAction(QLatin1String("level"), levelAction);
     connect(levelAction, &QAction::triggered, this, &KapmanMainWindow::changeLevel);
+    m_seekAction = new QAction(i18n("&Go to Time..."), this);
+    actionCollection()->addAction(QLatin1String("seek"), m_seekAction);
+    connect(m_seekAction, &QAction::triggered, this, &KapmanMainWindow::seekReplay);
     // Add a statusbar to show level,score,lives information
     m_statusBar = statusBar();
     mLevel = new QLabel(i18nc("Used to display the current level of play to the user", "Level: %1", 1));
@@ -86,8 +97,17 @@ KapmanMainWindow::~KapmanMainWindow()
 void KapmanMainWindow::initGame()
 {
     // Create a new Game instance
+    setGame(new Game(m_isSeeded ? m_seed : quint64(QDateTime::currentMSecsSinceEpoch())));
+}
+
+void KapmanMainWindow::setGame(Game *p_game)
+{
     delete m_game;
-    m_game = new Game();
+    m_game = p_game;
+    m_game->setTurbo(m_turboTicks);
+    m_game->setThreaded(m_isThreaded);
+    // Only a replay can be played from any time
+    m_seekAction->setEnabled(m_game->isReplay());
     connect(m_game, SIGNAL(gameOver(bool)), this, SLOT(newGame(bool)));     // TODO Remove the useless bool parameter from gameOver()
     connect(m_game, &Game::levelChanged, this, &KapmanMainWindow::displayLevel);
     connect(m_game, &Game::scoreChanged, this, &KapmanMainWindow::displayScore);
@@ -131,27 +151,100 @@ void KapmanMainWindow::newGame(const bool gameOver)
     } else {
         // Display the score information
         KMessageBox::information(this, i18np("Your score is %1 point.", "Your score is %1 points.", m_game->getScore()), i18n("Game Over"));
-        // manage Highscores only if player did not cheat
-        if (m_game->isCheater()) {
-            KMessageBox::information(this, i18n("You cheated, no Highscore for you ;)"), i18n("Cheater!"));
-        } else {
-            // Add the score to the highscores table
-            QPointer<KScoreDialog> dialog = new KScoreDialog(KScoreDialog::Name | KScoreDialog::Score | KScoreDialog::Level, this);
-            dialog->initFromDifficulty(Kg::difficulty());
-            KScoreDialog::FieldInfo scoreInfo;
-            scoreInfo[KScoreDialog::Level].setNum(m_game->getLevel());
-            scoreInfo[KScoreDialog::Score].setNum(m_game->getScore());
-            // If the new score is a highscore then display the highscore dialog
-            if (dialog->addScore(scoreInfo)) {
-                dialog->exec();
+        // manage Highscores only if player did not cheat, a replay not being a new score
+        if (!m_game->isReplay()) {
+            if (m_game->isCheater()) {
+                KMessageBox::information(this, i18n("You cheated, no Highscore for you ;)"), i18n("Cheater!"));
+            } else {
+                // Add the score to the highscores table
+                QPointer<KScoreDialog> dialog = new KScoreDialog(KScoreDialog::Name | KScoreDialog::Score | KScoreDialog::Level, this);
+                dialog->initFromDifficulty(Kg::difficulty());
+                KScoreDialog::FieldInfo scoreInfo;
+                scoreInfo[KScoreDialog::Level].setNum(m_game->getLevel());
+                scoreInfo[KScoreDialog::Score].setNum(m_game->getScore());
+                // If the new score is a highscore then display the highscore dialog
+                if (dialog->addScore(scoreInfo)) {
+                    dialog->exec();
+                }
+                delete dialog;
             }
-            delete dialog;
         }
         // Start a new game
         initGame();
     }
 }
 
+void KapmanMainWindow::loadReplay()
+{
+    const bool gameRunning = m_game->getTimer()->isActive();
+    // If the game is running
+    if (gameRunning) {
+        // Pause the game
+        m_game->pause();
+    }
+    const QString fileName = QFileDialog::getOpenFileName(this, i18n("Load Replay"), QString(), i18n("Kapman replays (*.kapreplay)"));
+    if (!fileName.isEmpty()) {
+        QFile file(fileName);
+        Recording *replay = new Recording();
+        if (file.open(QIODevice::ReadOnly) && replay->load(file.readAll())) {
+            // Play the replay instead of the current game
+            setGame(new Game(replay));
+            return;
+        }
+        delete replay;
+        KMessageBox::sorry(this, i18n("The file %1 is not a valid Kapman replay.", fileName), i18n("Load Replay"));
+    }
+    // If the game was running
+    if (gameRunning) {
+        // Resume the game
+        m_game->start();
+    }
+}
+
+void KapmanMainWindow::saveReplay()
+{
+    const bool gameRunning = m_game->getTimer()->isActive();
+    // If the game is running
+    if (gameRunning) {
+        // Pause the game
+        m_game->pause();
+    }
+    const QString fileName = QFileDialog::getSaveFileName(this, i18n("Save Replay"), QString(), i18n("Kapman replays (*.kapreplay)"));
+    if (!fileName.isEmpty()) {
+        QFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly) || file.write(m_game->getRecording()->save()) == -1) {
+            KMessageBox::sorry(this, i18n("The replay could not be saved to %1.", fileName), i18n("Save Replay"));
+        }
+    }
+    // If the game was running
+    if (gameRunning) {
+        // Resume the game
+        m_game->start();
+    }
+}
+
+void KapmanMainWindow::seekReplay()
+{
+    const bool gameRunning = m_game->getTimer()->isActive();
+    // If the game is running
+    if (gameRunning) {
+        // Pause the game
+        m_game->pause();
+    }
+    bool ok;
+    const int second = QInputDialog::getInt(this, i18n("Go to Time"), i18n("Second of the replay"), m_game->getTick() / GameState::TICKS_PER_SECOND,
+                                            0, m_game->getRecording()->getLength() / GameState::TICKS_PER_SECOND, 1, &ok);
+    // The game waits for a key press once at the wanted time
+    if (ok && m_game->seek(second * GameState::TICKS_PER_SECOND)) {
+        return;
+    }
+    // If the game was running
+    if (gameRunning) {
+        // Resume the game
+        m_game->start();
+    }
+}
+
 void KapmanMainWindow::changeLevel()
 {
     const int newLevel = QInputDialog::getInt(this, i18n("Change level"), i18nc("The number of the game level", "Level"), m_game->getLevel(), 1, 1000000, 1);
@@ -27,6 +27,7 @@
 
 static const int initLives = 3;
 
+class QAction;
 class QStatusBar;
 class QLabel;
 
@@ -46,6 +47,21 @@ private :
     /** The Game instance that manages the main loop and events */
     Game *m_game;
 
+    /** True if every game is started from the seed below, false if each game gets a new seed */
+    bool m_isSeeded;
+
+    /** The seed the games are started from */
+    quint64 m_seed;
+
+    /** The number of ticks the games run before drawing each frame, 0 to run them at the clock rate */
+    int m_turboTicks;
+
+    /** True if the games run their ticks on a simulation thread */
+    bool m_isThreaded;
+
+    /** The action which plays a replay from a given time */
+    QAction *m_seekAction;
+
     QStatusBar *m_statusBar;
     QLabel *mLevel;
     QLabel *mScore;
@@ -55,8 +71,12 @@ public:
 
     /**
      * Creates a new KapmanMainWindow instance.
+     * @param p_isSeeded true if every game has to be started from the given seed, to play the same game again
+     * @param p_seed the seed of the games
+     * @param p_turboTicks the number of ticks the games run as fast as possible before drawing each frame, 0 to run them at the clock rate
+     * @param p_isThreaded true if the games have to run their ticks on a simulation thread
      */
-    KapmanMainWindow();
+    explicit KapmanMainWindow(const bool p_isSeeded = false, const quint64 p_seed = 0, const int p_turboTicks = 0, const bool p_isThreaded = false);
 
     /**
      * Deletes the KapmanMainWindow instance.
@@ -71,12 +91,33 @@ private slots:
      */
     void initGame();
 
+    /**
+     * Replaces the current Game and creates a new GameView instance that displays it.
+     * @param p_game the new Game
+     */
+    void setGame(Game *p_game);
+
     /**
      * Starts a new game.
      * @param p_gameOver true if the game was over, false if a game is running
      */
     void newGame(const bool p_gameOver = false);
 
+    /**
+     * Shows a dialog enabling to choose a replay, and plays it.
+     */
+    void loadReplay();
+
+    /**
+     * Shows a dialog enabling to save the replay of the current game.
+     */
+    void saveReplay();
+
+    /**
+     * Shows a dialog enabling to choose a time of the replay, and goes to it.
+     */
+    void seekReplay();
+
     /**
      * Shows the highscores dialog.
      */
@@ -16,13 +16,11 @@
  */
 
 #include "kapmanparser.h"
-#include "element.h"
-#include "pill.h"
-#include "energizer.h"
 
-KapmanParser::KapmanParser(Game *p_game)
+KapmanParser::KapmanParser(Maze *p_maze, GameState *p_gameState)
 {
-    m_game = p_game;
+    m_maze = p_maze;
+    m_gameState = p_gameState;
     m_counterRows = 0;
 }
 
@@ -31,6 +29,11 @@ KapmanParser::~KapmanParser()
 
 }
 
+const QStringList &KapmanParser::getGhostImageIds() const
+{
+    return m_ghostImageIds;
+}
+
 bool KapmanParser::characters(const QString &ch)
 {
     m_buffer = ch;
@@ -55,7 +58,7 @@ bool KapmanParser::startElement(const QString &, const QString &, const QString
             }
         }
         // Create the Maze matrix
-        m_game->getMaze()->init(nbRows, nbColumns);
+        m_maze->init(nbRows, nbColumns);
     } else if (p_qName == QLatin1String("Bonus")) {
         // Initialize the number of rows and columns
         for (int i = 0; i < p_atts.count(); ++i) {
@@ -76,7 +79,7 @@ bool KapmanParser::startElement(const QString &, const QString &, const QString
                 }
             }
         }
-        m_game->createBonus(QPointF(x_position, y_position));
+        m_gameState->setBonus(qRound(x_position * Cell::SUBCELLS), qRound(y_position * Cell::SUBCELLS));
     } else if (p_qName == QLatin1String("Kapman")) {
         // Initialize the number of rows and columns
         for (int i = 0; i < p_atts.count(); ++i) {
@@ -97,7 +100,7 @@ bool KapmanParser::startElement(const QString &, const QString &, const QString
                 }
             }
         }
-        m_game->createKapman(QPointF(x_position, y_position));
+        m_gameState->setKapman(qRound(x_position * Cell::SUBCELLS), qRound(y_position * Cell::SUBCELLS));
     } else if (p_qName == QLatin1String("Ghost")) {
         QString imageId;
         // Initialize the number of rows and columns
@@ -122,7 +125,29 @@ bool KapmanParser::startElement(const QString &, const QString &, const QString
                 imageId = p_atts.value(i);
             }
         }
-        m_game->createGhost(QPointF(x_position, y_position), imageId);
+        m_gameState->addGhost(qRound(x_position * Cell::SUBCELLS), qRound(y_position * Cell::SUBCELLS));
+        m_ghostImageIds.append(imageId);
+    } else if (p_qName == QLatin1String("Portal")) {
+        int row = -1;
+        int column = -1;
+        int targetRow = -1;
+        int targetColumn = -1;
+        // Initialize the coordinates of the two linked cells
+        for (int i = 0; i < p_atts.count(); ++i) {
+            if (p_atts.qName(i) == QLatin1String("rowIndex")) {
+                row = p_atts.value(i).toInt();
+            }
+            if (p_atts.qName(i) == QLatin1String("colIndex")) {
+                column = p_atts.value(i).toInt();
+            }
+            if (p_atts.qName(i) == QLatin1String("targetRowIndex")) {
+                targetRow = p_atts.value(i).toInt();
+            }
+            if (p_atts.qName(i) == QLatin1String("targetColIndex")) {
+                targetColumn = p_atts.value(i).toInt();
+            }
+        }
+        m_maze->addPortal(row, column, targetRow, targetColumn);
     }
 
     return true;
@@ -134,26 +159,28 @@ bool KapmanParser::endElement(const QString &, const QString &, const QString &p
         for (int i = 0; i < m_buffer.length(); ++i) {
             switch (m_buffer.at(i).toLatin1()) {
             case '|':
-            case '=': m_game->getMaze()->setCellType(m_counterRows, i, Cell::WALL);
+            case '=': m_maze->setCellType(m_counterRows, i, Cell::WALL);
                 break;
-            case ' ': m_game->getMaze()->setCellType(m_counterRows, i, Cell::CORRIDOR);
+            case ' ': m_maze->setCellType(m_counterRows, i, Cell::CORRIDOR);
                 break;
-            case '.': m_game->getMaze()->setCellType(m_counterRows, i, Cell::CORRIDOR);
-                m_game->getMaze()->setCellElement(m_counterRows, i,
-                                                  new Pill(m_counterRows, i, m_game->getMaze(), QLatin1String("pill")));
+            case '.': m_maze->setCellType(m_counterRows, i, Cell::CORRIDOR);
+                m_maze->setConsumable(m_counterRows, i, Maze::PILL);
                 break;
-            case 'o': m_game->getMaze()->setCellType(m_counterRows, i, Cell::CORRIDOR);
-                m_game->getMaze()->setCellElement(m_counterRows, i,
-                                                  new Energizer(m_counterRows, i, m_game->getMaze(), QLatin1String("energizer")));
+            case 'o': m_maze->setCellType(m_counterRows, i, Cell::CORRIDOR);
+                m_maze->setConsumable(m_counterRows, i, Maze::ENERGIZER);
                 break;
-            case 'x': m_game->getMaze()->setCellType(m_counterRows, i, Cell::GHOSTCAMP);
+            case 'x': m_maze->setCellType(m_counterRows, i, Cell::GHOSTCAMP);
                 break;
-            case 'X': m_game->getMaze()->setCellType(m_counterRows, i, Cell::GHOSTCAMP);
-                m_game->getMaze()->setResurrectionCell(QPoint(m_counterRows, i));
+            case 'X': m_maze->setCellType(m_counterRows, i, Cell::GHOSTCAMP);
+                m_maze->setResurrectionCell(QPoint(m_counterRows, i));
                 break;
             }
         }
         ++m_counterRows;
+    } else if (p_qName == QLatin1String("Maze")) {
+        // All the Cells are set : compute the Maze data which depends on them
+        m_maze->prepare();
+        m_gameState->resetConsumables();
     }
     return true;
 }
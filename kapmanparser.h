@@ -19,20 +19,30 @@
 #ifndef KAPMANPARSER_H
 #define KAPMANPARSER_H
 
-#include "game.h"
+#include "gamestate.h"
 
+#include <QStringList>
 #include <QXmlDefaultHandler>
 
 /**
  * @brief This class handles XML reader events in order to initialize the Maze properties.
+ *
+ * It fills the Maze with its Cells and the Pills & Energizers they hold, and gives the GameState the characters initial coordinates,
+ * without creating any object to draw : the same Maze file can be played with or without a view.
  */
 class KapmanParser : public QXmlDefaultHandler
 {
 
 private:
 
-    /** The Game to initialize */
-    Game *m_game;
+    /** The Maze to initialize */
+    Maze *m_maze;
+
+    /** The GameState to initialize */
+    GameState *m_gameState;
+
+    /** The images of the Ghosts, in the order they have been added to the GameState */
+    QStringList m_ghostImageIds;
 
     /** The parser's buffer */
     QString m_buffer;
@@ -43,15 +53,21 @@ public:
 
     /**
      * Creates a new GameParser.
-     * @param p_game the Game to initialize
+     * @param p_maze the Maze to initialize
+     * @param p_gameState the GameState to initialize, which must play on the Maze
      */
-    explicit KapmanParser(Game *p_game);
+    KapmanParser(Maze *p_maze, GameState *p_gameState);
 
     /**
      * Deletes the GameParser instance.
      */
     ~KapmanParser();
 
+    /**
+     * @return the images of the Ghosts, in the order they have been added to the GameState
+     */
+    const QStringList &getGhostImageIds() const;
+
     /**
     * Implement QXmlDefaultHandler::characters
     */
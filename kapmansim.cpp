@@ -0,0 +1,381 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.h"
+#include "gamestate.h"
+#include "kapmanparser.h"
+#include "recording.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRunnable>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QXmlSimpleReader>
+
+namespace
+{
+/** The names of the difficulty levels, in the GameState::Difficulty order */
+const char *const DIFFICULTY_NAMES[] = {"easy", "medium", "hard"};
+
+/** The Directions the random policy chooses from */
+const Maze::Direction DIRECTIONS[] = {Maze::UP, Maze::RIGHT, Maze::DOWN, Maze::LEFT};
+
+/** The chance the random policy asks for a new Direction at each tick is one in this number */
+const int RANDOM_POLICY_PERIOD = 8;
+
+/**
+ * @brief A Maze file loaded once and played by several games.
+ */
+struct Setup {
+    /** The Maze, which the games only read */
+    Maze maze;
+    /** The GameState before the first tick, which the games are copied from */
+    GameState *gameState;
+    /** The images of the Ghosts, which name the death causes */
+    QStringList ghostImageIds;
+
+    Setup() : gameState(NULL) {}
+    ~Setup()
+    {
+        delete gameState;
+    }
+};
+
+/**
+ * @brief The result of a simulated game.
+ */
+struct Result {
+    /** The seed of the game */
+    quint64 seed;
+    /** The game difficulty */
+    GameState::Difficulty difficulty;
+    /** The final score */
+    long score;
+    /** The level reached */
+    int level;
+    /** The number of ticks the Kapman has survived */
+    int ticks;
+    /** The image of the Ghost which has caught the Kapman, for each death */
+    QStringList deathCauses;
+};
+
+/**
+ * Parses a Maze file into a Setup.
+ * @param p_setup the Setup to fill
+ * @param p_maze the XML description of the Maze
+ * @param p_difficulty the game difficulty
+ * @param p_seed the seed of the random-number generator
+ * @return true if the Maze file holds a Kapman, false otherwise
+ */
+bool loadSetup(Setup &p_setup, const QByteArray &p_maze, const GameState::Difficulty p_difficulty, const quint64 p_seed)
+{
+    p_setup.gameState = new GameState(&p_setup.maze, p_difficulty, p_seed);
+    KapmanParser kapmanParser(&p_setup.maze, p_setup.gameState);
+    QXmlInputSource source;
+    source.setData(p_maze);
+    QXmlSimpleReader reader;
+    reader.setContentHandler(&kapmanParser);
+    if (!reader.parse(source) || p_setup.maze.getNbRows() == 0) {
+        return false;
+    }
+    p_setup.ghostImageIds = kapmanParser.getGhostImageIds();
+    p_setup.gameState->initCharacters();
+    return true;
+}
+
+/**
+ * @brief This class plays one game without drawing it, with random inputs or the ones of a Recording.
+ */
+class Simulation : public QRunnable
+{
+
+private:
+
+    /** The Maze file and the GameState before the first tick */
+    const Setup *m_setup;
+
+    /** The seed of the game */
+    quint64 m_seed;
+
+    /** The Recording to play, NULL to play random inputs */
+    Recording *m_replay;
+
+    /** The maximum number of ticks to run */
+    int m_maxTicks;
+
+    /** The result to fill */
+    Result *m_result;
+
+public:
+
+    /**
+     * Creates a new Simulation instance.
+     * @param p_setup the Maze file and the GameState before the first tick
+     * @param p_seed the seed of the game
+     * @param p_replay the Recording to play, NULL to play random inputs
+     * @param p_maxTicks the maximum number of ticks to run
+     * @param p_result the result to fill
+     */
+    Simulation(const Setup *p_setup, const quint64 p_seed, Recording *p_replay, const int p_maxTicks, Result *p_result) :
+        m_setup(p_setup), m_seed(p_seed), m_replay(p_replay), m_maxTicks(p_maxTicks), m_result(p_result)
+    {
+    }
+
+    /**
+     * Plays the game until the Kapman has no life left or the maximum number of ticks has been run.
+     */
+    void run() Q_DECL_OVERRIDE
+    {
+        GameState gameState(*m_setup->gameState);
+        // The random policy has its own generator, so that the Ghosts do the same whatever the Kapman does
+        RandomGenerator policy(~m_seed);
+        Maze::Direction input = Maze::NONE;
+
+        gameState.setSeed(m_seed);
+        m_result->seed = m_seed;
+        m_result->difficulty = gameState.getDifficulty();
+        while (gameState.getLives() > 0 && gameState.getTick() < m_maxTicks) {
+            if (m_replay != NULL) {
+                if (m_replay->playInputs(&gameState, input)) {
+                    continue;
+                }
+            } else if (policy.bounded(RANDOM_POLICY_PERIOD) == 0) {
+                input = DIRECTIONS[policy.bounded(4)];
+            }
+            gameState.step(input);
+            input = Maze::NONE;
+            // Go on after the deaths and the levels as the Game does once the player is ready
+            const QVector<GameState::Event> &events = gameState.getEvents();
+            for (int i = 0; i < events.size(); ++i) {
+                if (events[i].type == GameState::KAPMAN_DEATH) {
+                    m_result->deathCauses.append(m_setup->ghostImageIds.value(events[i].index));
+                    if (gameState.getLives() > 0) {
+                        gameState.initCharacters();
+                    }
+                } else if (events[i].type == GameState::LEVEL_COMPLETED) {
+                    gameState.initCharacters();
+                }
+            }
+        }
+        m_result->score = gameState.getScore();
+        m_result->level = gameState.getLevel();
+        m_result->ticks = gameState.getTick();
+    }
+};
+
+/**
+ * Writes the results as CSV, one line per game.
+ */
+void writeCsv(QTextStream &p_stream, const QVector<Result> &p_results)
+{
+    p_stream << "seed,difficulty,score,level,ticks,deaths,death_causes\n";
+    for (int i = 0; i < p_results.size(); ++i) {
+        const Result &result = p_results[i];
+        p_stream << result.seed << ',' << DIFFICULTY_NAMES[result.difficulty] << ',' << qint64(result.score) << ','
+                 << result.level << ',' << result.ticks << ',' << result.deathCauses.size() << ','
+                 << result.deathCauses.join(QLatin1Char(';')) << '\n';
+    }
+}
+
+/**
+ * Writes the results as a JSON array, one object per game.
+ */
+void writeJson(QTextStream &p_stream, const QVector<Result> &p_results)
+{
+    QJsonArray games;
+    for (int i = 0; i < p_results.size(); ++i) {
+        const Result &result = p_results[i];
+        QJsonObject game;
+        // The seed may not fit in a JSON number
+        game[QStringLiteral("seed")] = QString::number(result.seed);
+        game[QStringLiteral("difficulty")] = QLatin1String(DIFFICULTY_NAMES[result.difficulty]);
+        game[QStringLiteral("score")] = double(result.score);
+        game[QStringLiteral("level")] = result.level;
+        game[QStringLiteral("ticks")] = result.ticks;
+        game[QStringLiteral("deathCauses")] = QJsonArray::fromStringList(result.deathCauses);
+        games.append(game);
+    }
+    p_stream << QJsonDocument(games).toJson();
+}
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("kapman"));
+
+    // Command line arguments
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Plays Kapman games without drawing them and writes their results."));
+    parser.addHelpOption();
+    const QCommandLineOption gamesOption(QStringLiteral("games"), QStringLiteral("Number of games with random inputs to play (default 1000)."), QStringLiteral("number"), QStringLiteral("1000"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Seed of the first game, the next ones following (default 1)."), QStringLiteral("number"), QStringLiteral("1"));
+    const QCommandLineOption difficultyOption(QStringLiteral("difficulty"), QStringLiteral("easy, medium or hard (default medium)."), QStringLiteral("level"), QStringLiteral("medium"));
+    const QCommandLineOption mazeOption(QStringLiteral("maze"), QStringLiteral("Maze file (default the installed defaultmaze.xml)."), QStringLiteral("file"));
+    const QCommandLineOption maxTicksOption(QStringLiteral("max-ticks"), QStringLiteral("Maximum number of ticks of a game (default one hour)."), QStringLiteral("number"),
+                                            QString::number(GameState::TICKS_PER_SECOND * 3600));
+    const QCommandLineOption threadsOption(QStringLiteral("threads"), QStringLiteral("Number of games played at the same time (default one per core)."), QStringLiteral("number"),
+                                           QString::number(QThread::idealThreadCount()));
+    const QCommandLineOption formatOption(QStringLiteral("format"), QStringLiteral("csv or json (default csv)."), QStringLiteral("format"), QStringLiteral("csv"));
+    const QCommandLineOption benchmarkOption(QStringLiteral("benchmark"), QStringLiteral("Measures a part of the game on the maze instead of playing games: paths, hierarchy, snapshots or ticks."), QStringLiteral("name"));
+    const QCommandLineOption outputOption(QStringLiteral("output"), QStringLiteral("File to write the results to (default the standard output)."), QStringLiteral("file"));
+    parser.addOption(gamesOption);
+    parser.addOption(seedOption);
+    parser.addOption(difficultyOption);
+    parser.addOption(mazeOption);
+    parser.addOption(maxTicksOption);
+    parser.addOption(threadsOption);
+    parser.addOption(formatOption);
+    parser.addOption(benchmarkOption);
+    parser.addOption(outputOption);
+    parser.addPositionalArgument(QStringLiteral("replays"), QStringLiteral("Replay files to play instead of games with random inputs."), QStringLiteral("[replays...]"));
+    parser.process(app);
+
+    QTextStream errors(stderr);
+    bool isGamesValid, isSeedValid, isMaxTicksValid, isThreadsValid;
+    const int nbGames = parser.value(gamesOption).toInt(&isGamesValid);
+    const quint64 firstSeed = parser.value(seedOption).toULongLong(&isSeedValid);
+    const int maxTicks = parser.value(maxTicksOption).toInt(&isMaxTicksValid);
+    const int nbThreads = parser.value(threadsOption).toInt(&isThreadsValid);
+    const QStringList replayFiles = parser.positionalArguments();
+    if (!isGamesValid || nbGames <= 0) {
+        errors << "Bad number of games " << parser.value(gamesOption) << '\n';
+        return 1;
+    }
+    if (!isSeedValid) {
+        errors << "Bad seed " << parser.value(seedOption) << '\n';
+        return 1;
+    }
+    if (!isMaxTicksValid || maxTicks <= 0) {
+        errors << "Bad maximum number of ticks " << parser.value(maxTicksOption) << '\n';
+        return 1;
+    }
+    if (!isThreadsValid || nbThreads <= 0) {
+        errors << "Bad number of threads " << parser.value(threadsOption) << '\n';
+        return 1;
+    }
+    int difficulty = 0;
+    while (difficulty <= GameState::HARD && parser.value(difficultyOption) != QLatin1String(DIFFICULTY_NAMES[difficulty])) {
+        ++difficulty;
+    }
+    if (difficulty > GameState::HARD) {
+        errors << "Unknown difficulty " << parser.value(difficultyOption) << '\n';
+        return 1;
+    }
+
+    // Load the Maze once for all the games with random inputs, and each replay with its own Maze
+    QList<Setup *> setups;
+    QList<Recording *> replays;
+    QVector<Result> results;
+    if (replayFiles.isEmpty()) {
+        QString mazeFile = parser.value(mazeOption);
+        if (mazeFile.isEmpty()) {
+            mazeFile = QStandardPaths::locate(QStandardPaths::AppDataLocation, QStringLiteral("defaultmaze.xml"));
+        }
+        QFile file(mazeFile);
+        setups.append(new Setup());
+        if (!file.open(QIODevice::ReadOnly) || !loadSetup(*setups.last(), file.readAll(), GameState::Difficulty(difficulty), firstSeed)) {
+            errors << "Cannot load the maze " << mazeFile << '\n';
+            return 1;
+        }
+        results.resize(nbGames);
+    } else {
+        for (int i = 0; i < replayFiles.size(); ++i) {
+            QFile file(replayFiles[i]);
+            replays.append(new Recording());
+            setups.append(new Setup());
+            if (!file.open(QIODevice::ReadOnly) || !replays.last()->load(file.readAll())
+                || !loadSetup(*setups.last(), replays.last()->getMaze(), replays.last()->getDifficulty(), replays.last()->getSeed())) {
+                errors << "Cannot load the replay " << replayFiles[i] << '\n';
+                return 1;
+            }
+        }
+        results.resize(replays.size());
+    }
+
+    // Measure a part of the game rather than playing the games
+    if (parser.isSet(benchmarkOption)) {
+        QTextStream stream(stdout);
+        const QString benchmark = parser.value(benchmarkOption);
+        if (benchmark == QLatin1String("paths")) {
+            Benchmark::runPaths(stream, &setups.first()->maze);
+        } else if (benchmark == QLatin1String("hierarchy")) {
+            Benchmark::runHierarchy(stream);
+        } else if (benchmark == QLatin1String("snapshots")) {
+            Benchmark::runSnapshots(stream, setups.first()->gameState);
+        } else if (benchmark == QLatin1String("ticks")) {
+            Benchmark::runTicks(stream, &setups.first()->maze, setups.first()->gameState);
+        } else {
+            errors << "Unknown benchmark " << benchmark << '\n';
+            return 1;
+        }
+        qDeleteAll(replays);
+        qDeleteAll(setups);
+        return 0;
+    }
+
+    // Play the games on all the cores, each one filling its own result
+    QElapsedTimer clock;
+    clock.start();
+    QThreadPool::globalInstance()->setMaxThreadCount(nbThreads);
+    for (int i = 0; i < results.size(); ++i) {
+        if (replays.isEmpty()) {
+            QThreadPool::globalInstance()->start(new Simulation(setups.first(), firstSeed + i, NULL, maxTicks, &results[i]));
+        } else {
+            QThreadPool::globalInstance()->start(new Simulation(setups[i], replays[i]->getSeed(), replays[i], maxTicks, &results[i]));
+        }
+    }
+    QThreadPool::globalInstance()->waitForDone();
+    const qint64 elapsed = clock.nsecsElapsed();
+
+    // Write the results
+    QFile output;
+    if (parser.isSet(outputOption)) {
+        output.setFileName(parser.value(outputOption));
+        if (!output.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            errors << "Cannot write to " << parser.value(outputOption) << '\n';
+            return 1;
+        }
+    } else {
+        output.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+    }
+    QTextStream stream(&output);
+    if (parser.value(formatOption) == QLatin1String("json")) {
+        writeJson(stream, results);
+    } else {
+        writeCsv(stream, results);
+    }
+
+    qint64 nbTicks = 0;
+    for (int i = 0; i < results.size(); ++i) {
+        nbTicks += results[i].ticks;
+    }
+    errors << results.size() << " games, " << nbTicks << " ticks in " << elapsed / 1000000 << " ms ("
+           << (elapsed > 0 ? nbTicks * Q_INT64_C(1000000000) / elapsed : 0) << " ticks/s)\n";
+
+    qDeleteAll(replays);
+    qDeleteAll(setups);
+    return 0;
+}
@@ -53,13 +53,20 @@ int main(int argc, char **argv)
     KAboutData::setApplicationData(about);
     KCrash::initialize();
     about.setupCommandLine(&parser);
+    parser.addOption(QCommandLineOption(QStringLiteral("seed"), i18n("Start every game from the given random seed, to play the same game again"), i18n("number")));
+    parser.addOption(QCommandLineOption(QStringLiteral("turbo"), i18n("Run the games as fast as possible, drawing once every given number of ticks"), i18n("ticks")));
+    parser.addOption(QCommandLineOption(QStringLiteral("threaded"), i18n("Run the game ticks on a thread of their own, apart from the drawing")));
     parser.process(app);
     about.processCommandLine(&parser);
+    bool isSeeded = false;
+    const quint64 seed = parser.value(QStringLiteral("seed")).toULongLong(&isSeeded);
+    const int turboTicks = parser.value(QStringLiteral("turbo")).toInt();
+    const bool isThreaded = parser.isSet(QStringLiteral("threaded"));
     KDBusService service;
     // Set the application incon
     app.setWindowIcon(QIcon::fromTheme(QStringLiteral("kapman")));
     // Create the main window
-    KapmanMainWindow *window = new KapmanMainWindow();
+    KapmanMainWindow *window = new KapmanMainWindow(isSeeded, seed, turboTicks, isThreaded);
     // Show the main window
     window->show();
     // Execute the application
@@ -17,31 +17,89 @@
  */
 
 #include "maze.h"
+#include "clustergraph.h"
+#include "pathfinder.h"
 
-#include <math.h>
 #include <QDebug>
+#include <QtAlgorithms>
 
-Maze::Maze() : m_totalNbElem(0), m_nbElem(0)
+#include <algorithm>
+#include <functional>
+
+const int Maze::HIERARCHICAL_MIN_CELLS = 256 * 256;
+
+Maze::Maze() : m_totalNbElem(0), m_clusterGraph(0)
 {
 
 }
 
 Maze::~Maze()
 {
-    for (int i = 0 ; i < m_nbRows; ++i) {
-        delete[] m_cells[i];
-    }
-    delete[] m_cells;
+    delete m_clusterGraph;
 }
 
 void Maze::init(const int p_nbRows, const int p_nbColumns)
 {
     m_nbRows = p_nbRows;
     m_nbColumns = p_nbColumns;
-    m_cells = new Cell*[m_nbRows];
-    for (int i = 0; i < m_nbRows; ++i) {
-        m_cells[i] = new Cell[m_nbColumns];
+    m_cellTypes.fill(Cell::WALL, m_nbRows * m_nbColumns);
+    m_consumables.fill(NO_CONSUMABLE, m_nbRows * m_nbColumns);
+    m_totalNbElem = 0;
+    m_portals.clear();
+}
+
+void Maze::prepare()
+{
+    const int nbCells = m_nbRows * m_nbColumns;
+
+    computePortals();
+
+    // Compute the neighbours of each Cell, going through the portals
+    m_neighbours.fill(-1, nbCells * 4);
+    for (int i = 0; i < nbCells; ++i) {
+        computeNeighbours(i);
+    }
+    computeMoves();
+    computeCampDistances();
+    computeSegments();
+    computeJunctions();
+
+    // Build the hierarchical path finding graph for the large Mazes only
+    delete m_clusterGraph;
+    m_clusterGraph = 0;
+    if (nbCells >= HIERARCHICAL_MIN_CELLS) {
+        m_clusterGraph = new ClusterGraph();
+        m_clusterGraph->build(this);
+    }
+
+    // Compute the exit masks of each Cell
+    m_exits.fill(NONE, nbCells);
+    m_ghostExits.fill(NONE, nbCells);
+    for (int i = 0; i < nbCells; ++i) {
+        computeExits(i);
+    }
+}
+
+void Maze::openCell(const int p_row, const int p_column)
+{
+    if (p_row < 0 || p_row >= m_nbRows || p_column < 0 || p_column >= m_nbColumns) {
+        qCritical() << "Bad maze coordinates";
+        return;
+    }
+    changeCellType(getCellIndex(p_row, p_column), Cell::CORRIDOR);
+}
+
+void Maze::closeCell(const int p_row, const int p_column)
+{
+    if (p_row < 0 || p_row >= m_nbRows || p_column < 0 || p_column >= m_nbColumns) {
+        qCritical() << "Bad maze coordinates";
+        return;
     }
+    if (p_row == m_resurrectionCell.y() && p_column == m_resurrectionCell.x()) {
+        qCritical() << "The ghost resurrection cell cannot be closed";
+        return;
+    }
+    changeCellType(getCellIndex(p_row, p_column), Cell::WALL);
 }
 
 void Maze::setCellType(const int p_row, const int p_column, const Cell::Type p_type)
@@ -49,19 +107,28 @@ void Maze::setCellType(const int p_row, const int p_column, const Cell::Type p_t
     if (p_row < 0 || p_row >= m_nbRows || p_column < 0 || p_column >= m_nbColumns) {
         qCritical() << "Bad maze coordinates";
     }
-    m_cells[p_row][p_column].setType(p_type);
+    m_cellTypes[getCellIndex(p_row, p_column)] = p_type;
 }
 
-void Maze::setCellElement(const int p_row, const int p_column, Element *p_element)
+void Maze::setConsumable(const int p_row, const int p_column, const Consumable p_consumable)
 {
     if (p_row < 0 || p_row >= m_nbRows || p_column < 0 || p_column >= m_nbColumns) {
         qCritical() << "Bad maze coordinates";
+        return;
     }
-    m_cells[p_row][p_column].setElement(p_element);
-    if (p_element != NULL) {
-        m_totalNbElem++;
-        m_nbElem++;
+    quint8 &consumable = m_consumables[getCellIndex(p_row, p_column)];
+    m_totalNbElem += (p_consumable != NO_CONSUMABLE) - (consumable != NO_CONSUMABLE);
+    consumable = p_consumable;
+}
+
+void Maze::addPortal(const int p_row, const int p_column, const int p_otherRow, const int p_otherColumn)
+{
+    if (p_row < 0 || p_row >= m_nbRows || p_column < 0 || p_column >= m_nbColumns ||
+            p_otherRow < 0 || p_otherRow >= m_nbRows || p_otherColumn < 0 || p_otherColumn >= m_nbColumns) {
+        qCritical() << "Bad maze coordinates";
+        return;
     }
+    m_portals.append(qMakePair(getCellIndex(p_row, p_column), getCellIndex(p_otherRow, p_otherColumn)));
 }
 
 void Maze::setResurrectionCell(QPoint p_resurrectionCell)
@@ -71,149 +138,264 @@ void Maze::setResurrectionCell(QPoint p_resurrectionCell)
     m_resurrectionCell.setY(p_resurrectionCell.x());
 }
 
-void Maze::decrementNbElem()
+QList<QPoint> Maze::getPathToGhostCamp(const int p_row, const int p_column) const
 {
-    m_nbElem--;
-    if (m_nbElem == 0) {
-        emit(allElementsEaten());
+    QList<QPoint> path = findPath(p_row, p_column, m_resurrectionCell.y(), m_resurrectionCell.x());
+    if (path.isEmpty() && (p_row != m_resurrectionCell.y() || p_column != m_resurrectionCell.x())) {
+        qCritical() << "Path to ghost home not found";
     }
-}
 
-void Maze::resetNbElem()
-{
-    m_nbElem = m_totalNbElem;
+    return path;
 }
 
-QList<QPoint> Maze::getPathToGhostCamp(const int p_row, const int p_column) const
+QList<QPoint> Maze::findPath(const int p_fromRow, const int p_fromColumn, const int p_toRow, const int p_toColumn) const
 {
-    QList<QPoint> path;
-    QList<QPoint> openList;
-    QList<QPoint> closedList;
-    QPoint currentCell;
-    QPoint tmpCell;
-    int lowestCost;
-    int icurrent = 0;
-    int oldSize = 0;
-
-    // Initialize the starting cell
-    m_cells[p_row][p_column].setCost(abs(m_resurrectionCell.y() - p_row) + abs(m_resurrectionCell.x() - p_column));
-    // Add the starting cell to the openList
-    openList.append(QPoint(p_column, p_row));
-    // While the closed list does not contain the target cell
-    while (!closedList.contains(QPoint(m_resurrectionCell.x(), m_resurrectionCell.y())) && openList.size() != oldSize) {
-        // Look for the lowest cost cell on the open list
-        lowestCost = 1000;
-        for (int i = 0; i < openList.size(); ++i) {
-            if (m_cells[openList[i].y()][openList[i].x()].getCost() < lowestCost) {
-                lowestCost = m_cells[openList[i].y()][openList[i].x()].getCost();
-                currentCell = openList[i];
-                icurrent = i;
-            }
-        }
-        // Switch this cell to the closed list
-        closedList.append(currentCell);
-        openList.removeAt(icurrent);
-        oldSize = openList.size();
-        // For each of the 4 cells adjacent to the current node
-        // Left
-        tmpCell.setX(currentCell.x() - 1);
-        tmpCell.setY(currentCell.y());
-        if (m_cells[tmpCell.y()][tmpCell.x()].getType() != Cell::WALL) {
-            // If the cell is not in the closed list or the open list
-            if (!closedList.contains(tmpCell) && !openList.contains(tmpCell)) {
-                // Initialize the cell
-                m_cells[tmpCell.y()][tmpCell.x()].setCost(
-                    abs(m_resurrectionCell.y() - tmpCell.y()) + abs(m_resurrectionCell.x() - (tmpCell.x())));
-                m_cells[tmpCell.y()][tmpCell.x()].setParent(&m_cells[currentCell.y()][currentCell.x()]);
-                // Add it to the open list
-                openList.append(tmpCell);
-            }
-        }
-        // Right
-        tmpCell.setX(currentCell.x() + 1);
-        tmpCell.setY(currentCell.y());
-        if (m_cells[tmpCell.y()][tmpCell.x()].getType() != Cell::WALL) {
-            // If the cell is not in the closed list or the open list
-            if (!closedList.contains(tmpCell) && !openList.contains(tmpCell)) {
-                // Initialize the cell
-                m_cells[tmpCell.y()][tmpCell.x()].setCost(
-                    abs(m_resurrectionCell.y() - tmpCell.y()) + abs(m_resurrectionCell.x() - (tmpCell.x())));
-                m_cells[tmpCell.y()][tmpCell.x()].setParent(&m_cells[currentCell.y()][currentCell.x()]);
-                // Add it to the open list
-                openList.append(tmpCell);
-            }
-        }
-        // Top
-        tmpCell.setX(currentCell.x());
-        tmpCell.setY(currentCell.y() - 1);
-        if (m_cells[tmpCell.y()][tmpCell.x()].getType() != Cell::WALL) {
-            // If the cell is not in the closed list or the open list
-            if (!closedList.contains(tmpCell) && !openList.contains(tmpCell)) {
-                // Initialize the cell
-                m_cells[tmpCell.y()][tmpCell.x()].setCost(
-                    abs(m_resurrectionCell.y() - tmpCell.y()) + abs(m_resurrectionCell.x() - (tmpCell.x())));
-                m_cells[tmpCell.y()][tmpCell.x()].setParent(&m_cells[currentCell.y()][currentCell.x()]);
-                // Add it to the open list
-                openList.append(tmpCell);
-            }
-        }
-        // Bottom
-        tmpCell.setX(currentCell.x());
-        tmpCell.setY(currentCell.y() + 1);
-        if (m_cells[tmpCell.y()][tmpCell.x()].getType() != Cell::WALL) {
-            // If the cell is not in the closed list or the open list
-            if (!closedList.contains(tmpCell) && !openList.contains(tmpCell)) {
-                // Initialize the cell
-                m_cells[tmpCell.y()][tmpCell.x()].setCost(
-                    abs(m_resurrectionCell.y() - tmpCell.y()) + abs(m_resurrectionCell.x() - (tmpCell.x())));
-                m_cells[tmpCell.y()][tmpCell.x()].setParent(&m_cells[currentCell.y()][currentCell.x()]);
-                // Add it to the open list
-                openList.append(tmpCell);
-            }
-        }
-    }
-    if (oldSize == openList.size()) {
-        qCritical() << "Path to ghost home not found";
+    // Each thread keeps its own search data, so that several paths can be computed at the same time
+    static thread_local PathFinder pathFinder;
+
+    if (p_fromRow < 0 || p_fromRow >= m_nbRows || p_fromColumn < 0 || p_fromColumn >= m_nbColumns ||
+            p_toRow < 0 || p_toRow >= m_nbRows || p_toColumn < 0 || p_toColumn >= m_nbColumns) {
+        qCritical() << "Bad maze coordinates";
         return QList<QPoint>();
     }
-    // Save the path : from the target cell, go from each cell to its parent cell until reaching the starting cell
-    for (Cell *cell = &m_cells[m_resurrectionCell.y()][m_resurrectionCell.x()];
-            cell->getParent() != &m_cells[p_row][p_column]; cell = cell->getParent()) {
-        path.prepend(getCoords(cell));
+    if (m_clusterGraph) {
+        return m_clusterGraph->findPath(p_fromRow, p_fromColumn, p_toRow, p_toColumn);
     }
+    return pathFinder.findPath(this, p_fromRow, p_fromColumn, p_toRow, p_toColumn);
+}
 
-    return path;
+Maze::Direction Maze::getDirectionToGhostCamp(const int p_row, const int p_column) const
+{
+    return (Direction)m_campDirections[getCellIndex(p_row, p_column)];
+}
+
+int Maze::getExits(const int p_row, const int p_column) const
+{
+    return m_exits[getCellIndex(p_row, p_column)];
 }
 
-Cell Maze::getCell(const int p_row, const int p_column) const
+int Maze::getGhostExits(const int p_row, const int p_column) const
+{
+    return m_ghostExits[getCellIndex(p_row, p_column)];
+}
+
+int Maze::getDistanceToGhostCamp(const int p_row, const int p_column) const
+{
+    return m_campDistances[getCellIndex(p_row, p_column)];
+}
+
+Cell::Type Maze::getCellType(const int p_row, const int p_column) const
 {
     if (p_row < 0 || p_row >= m_nbRows ||
             p_column < 0 || p_column >= m_nbColumns) {
         qCritical() << "Bad maze coordinates";
+        return Cell::WALL;
+    }
+    return (Cell::Type)m_cellTypes[getCellIndex(p_row, p_column)];
+}
+
+Cell::Type Maze::getCellType(const int p_index) const
+{
+    return (Cell::Type)m_cellTypes[p_index];
+}
+
+Maze::Consumable Maze::getConsumable(const int p_index) const
+{
+    return (Consumable)m_consumables[p_index];
+}
+
+const QVector<quint8> &Maze::getConsumables() const
+{
+    return m_consumables;
+}
+
+int Maze::getCellIndex(const int p_row, const int p_column) const
+{
+    return p_row * m_nbColumns + p_column;
+}
+
+int Maze::getRowFromIndex(const int p_index) const
+{
+    return p_index / m_nbColumns;
+}
+
+int Maze::getColumnFromIndex(const int p_index) const
+{
+    return p_index % m_nbColumns;
+}
+
+QPoint Maze::getCoords(const int p_index) const
+{
+    return QPoint(p_index % m_nbColumns, p_index / m_nbColumns);
+}
+
+int Maze::getNeighbourIndex(const int p_index, const Direction p_direction) const
+{
+    switch (p_direction) {
+    case UP:
+        return m_neighbours[p_index * 4];
+    case RIGHT:
+        return m_neighbours[p_index * 4 + 1];
+    case DOWN:
+        return m_neighbours[p_index * 4 + 2];
+    case LEFT:
+        return m_neighbours[p_index * 4 + 3];
+    case NONE:
+        break;
+    }
+    return p_index;
+}
+
+void Maze::getPreviousCells(const int p_index, QVector<int> &p_cells) const
+{
+    p_cells.clear();
+    for (int i = m_firstMoves[p_index]; i < m_firstMoves[p_index + 1]; ++i) {
+        p_cells.append(m_moves[i] / 4);
+    }
+}
+
+int Maze::getPortalExit(const int p_row, const int p_column) const
+{
+    if (p_row < 0 || p_row >= m_nbRows || p_column < 0 || p_column >= m_nbColumns) {
+        return -1;
     }
-    return m_cells[p_row][p_column];
+    return m_portalExits[getCellIndex(p_row, p_column)];
 }
 
-QPoint Maze::getCoords(Cell *p_cell) const
+Maze::Direction Maze::getPortalDirection(const int p_row, const int p_column) const
 {
-    for (int i = 0; i < m_nbRows; ++i) {
-        for (int j = 0; j < m_nbColumns; ++j) {
-            if (&m_cells[i][j] == p_cell) {
-                return QPoint(j, i);
+    if (p_row < 0 || p_row >= m_nbRows || p_column < 0 || p_column >= m_nbColumns) {
+        return NONE;
+    }
+    return (Direction)m_portalDirections[getCellIndex(p_row, p_column)];
+}
+
+bool Maze::isInLineSight(const int p_fromRow, const int p_fromColumn, const Direction p_direction, const int p_toRow, const int p_toColumn) const
+{
+    if (p_direction == NONE || p_fromRow < 0 || p_fromRow >= m_nbRows || p_fromColumn < 0 || p_fromColumn >= m_nbColumns ||
+            p_toRow < 0 || p_toRow >= m_nbRows || p_toColumn < 0 || p_toColumn >= m_nbColumns) {
+        return false;
+    }
+    const int from = getCellIndex(p_fromRow, p_fromColumn) * 2 + ((p_direction & (LEFT | RIGHT)) ? 0 : 1);
+    const int segment = m_segments[from];
+    if (segment == -1 || (p_fromRow == p_toRow && p_fromColumn == p_toColumn)) {
+        return false;
+    }
+    // After a portal, the run may go on along the other axis
+    for (int i = 0; i < 2; ++i) {
+        const int to = getCellIndex(p_toRow, p_toColumn) * 2 + i;
+        if (m_segments[to] == segment) {
+            if (m_cyclicSegments[segment]) {
+                return true;
             }
+            if (m_segmentDirections[from] == p_direction) {
+                return m_segmentPositions[to] > m_segmentPositions[from];
+            }
+            return m_segmentPositions[to] < m_segmentPositions[from];
+        }
+    }
+    return false;
+}
+
+int Maze::getPassages(const int p_index) const
+{
+    static const Direction directions[4] = {UP, RIGHT, DOWN, LEFT};
+
+    int passages = NONE;
+    for (int i = 0; i < 4; ++i) {
+        const int next = m_neighbours[p_index * 4 + i];
+        if (next != -1 && m_cellTypes[next] != Cell::WALL) {
+            passages |= directions[i];
+        }
+    }
+    return passages;
+}
+
+int Maze::getJunction(const int p_index) const
+{
+    return m_junctions[p_index];
+}
+
+int Maze::getNbJunctions() const
+{
+    return m_junctionCells.size();
+}
+
+int Maze::getJunctionCell(const int p_junction) const
+{
+    return m_junctionCells[p_junction];
+}
+
+int Maze::getJunctionEdge(const int p_junction, const Direction p_direction) const
+{
+    switch (p_direction) {
+    case UP:
+        return m_junctionEdges[p_junction * 4];
+    case RIGHT:
+        return m_junctionEdges[p_junction * 4 + 1];
+    case DOWN:
+        return m_junctionEdges[p_junction * 4 + 2];
+    case LEFT:
+        return m_junctionEdges[p_junction * 4 + 3];
+    case NONE:
+        break;
+    }
+    return -1;
+}
+
+int Maze::getJunctionEdgeLength(const int p_junction, const Direction p_direction) const
+{
+    switch (p_direction) {
+    case UP:
+        return m_junctionEdgeLengths[p_junction * 4];
+    case RIGHT:
+        return m_junctionEdgeLengths[p_junction * 4 + 1];
+    case DOWN:
+        return m_junctionEdgeLengths[p_junction * 4 + 2];
+    case LEFT:
+        return m_junctionEdgeLengths[p_junction * 4 + 3];
+    case NONE:
+        break;
+    }
+    return 0;
+}
+
+int Maze::followCorridor(const int p_index, Direction &p_direction) const
+{
+    const int next = getNeighbourIndex(p_index, p_direction);
+    p_direction = getDirectionAfterMove(p_index, p_direction);
+    if (next != -1 && m_junctions[next] == -1) {
+        // Go on along the corridor : take the passage which does not lead back
+        const int passages = getPassages(next) & ~getOppositeDirection(p_direction);
+        p_direction = (Direction)(passages & -passages);
+    }
+    return next;
+}
+
+bool Maze::hasPortals() const
+{
+    for (int i = 0; i < m_portalExits.size(); ++i) {
+        if (m_portalExits[i] != -1) {
+            return true;
         }
     }
-    return QPoint();
+    return false;
 }
 
-int Maze::getRowFromY(const qreal p_y) const
+Maze::Direction Maze::getOppositeDirection(const Direction p_direction)
 {
-    return (int)(p_y / Cell::SIZE);
+    // UP and DOWN, and RIGHT and LEFT, are two bits away from each other
+    return (Direction)(((p_direction << 2) | (p_direction >> 2)) & (UP | RIGHT | DOWN | LEFT));
 }
 
-int Maze::getColFromX(const qreal p_x) const
+int Maze::getRowFromY(const int p_y)
 {
-    return (int)(p_x / Cell::SIZE);
+    return p_y >> Cell::SUBCELL_BITS;
+}
+
+int Maze::getColFromX(const int p_x)
+{
+    return p_x >> Cell::SUBCELL_BITS;
 }
 
 int Maze::getNbColumns() const
@@ -226,11 +408,6 @@ int Maze::getNbRows() const
     return m_nbRows;
 }
 
-int Maze::getNbElem() const
-{
-    return m_nbElem;
-}
-
 int Maze::getTotalNbElem() const
 {
     return m_totalNbElem;
@@ -240,3 +417,589 @@ QPoint Maze::getResurrectionCell() const
 {
     return m_resurrectionCell;
 }
+
+int Maze::getAdjacentIndex(const int p_index, const Direction p_direction) const
+{
+    switch (p_direction) {
+    case UP:
+        return p_index >= m_nbColumns ? p_index - m_nbColumns : -1;
+    case RIGHT:
+        return (p_index + 1) % m_nbColumns != 0 ? p_index + 1 : -1;
+    case DOWN:
+        return p_index + m_nbColumns < m_cellTypes.size() ? p_index + m_nbColumns : -1;
+    case LEFT:
+        return p_index % m_nbColumns != 0 ? p_index - 1 : -1;
+    case NONE:
+        break;
+    }
+    return p_index;
+}
+
+Maze::Direction Maze::getDirectionAfterMove(const int p_index, const Direction p_direction) const
+{
+    const int adjacent = getAdjacentIndex(p_index, p_direction);
+    if (adjacent != -1 && m_portalExits[adjacent] != -1) {
+        return (Direction)m_portalDirections[adjacent];
+    }
+    return p_direction;
+}
+
+void Maze::computeSegments()
+{
+    const int nbCells = m_nbRows * m_nbColumns;
+
+    m_segments.fill(-1, nbCells * 2);
+    m_segmentPositions.fill(0, nbCells * 2);
+    m_segmentDirections.fill(NONE, nbCells * 2);
+    m_cyclicSegments.clear();
+    for (int i = 0; i < nbCells; ++i) {
+        labelSegments(i);
+    }
+}
+
+void Maze::labelSegments(const int p_index)
+{
+    const int nbCells = m_nbRows * m_nbColumns;
+
+    // A Character never stands on a portal, so they do not belong to any run
+    if (m_cellTypes[p_index] != Cell::CORRIDOR || m_portalExits[p_index] != -1) {
+        return;
+    }
+    for (int axis = 0; axis < 2; ++axis) {
+        if (m_segments[p_index * 2 + axis] != -1) {
+            continue;
+        }
+        // Go back to the first Cell of the run
+        int start = p_index;
+        Direction direction = axis == 0 ? LEFT : UP;
+        bool cyclic = false;
+        for (int j = 0; j < nbCells; ++j) {
+            const int previous = getNeighbourIndex(start, direction);
+            const Direction previousDirection = getDirectionAfterMove(start, direction);
+            // A run only goes through the portals that can be taken both ways
+            if (previous == -1 || m_cellTypes[previous] != Cell::CORRIDOR ||
+                    getNeighbourIndex(previous, getOppositeDirection(previousDirection)) != start) {
+                break;
+            }
+            if (previous == p_index) {
+                cyclic = true;
+                break;
+            }
+            direction = previousDirection;
+            start = previous;
+        }
+        // Then label the Cells of the run up to its last one
+        const int segment = m_cyclicSegments.size();
+        m_cyclicSegments.append(cyclic);
+        direction = getOppositeDirection(direction);
+        int cell = start;
+        for (int position = 0; cell != -1 && m_cellTypes[cell] == Cell::CORRIDOR; ++position) {
+            const int slot = cell * 2 + ((direction & (LEFT | RIGHT)) ? 0 : 1);
+            if (m_segments[slot] != -1) {
+                break;
+            }
+            m_segments[slot] = segment;
+            m_segmentPositions[slot] = position;
+            m_segmentDirections[slot] = direction;
+            const int next = getNeighbourIndex(cell, direction);
+            const Direction nextDirection = getDirectionAfterMove(cell, direction);
+            if (next != -1 && getNeighbourIndex(next, getOppositeDirection(nextDirection)) != cell) {
+                break;
+            }
+            direction = nextDirection;
+            cell = next;
+        }
+    }
+}
+
+void Maze::clearSegments(const int p_index, QVector<int> &p_cells)
+{
+    static const Direction directions[4] = {UP, RIGHT, DOWN, LEFT};
+
+    for (int axis = 0; axis < 2; ++axis) {
+        const int segment = m_segments[p_index * 2 + axis];
+        if (segment == -1) {
+            continue;
+        }
+        // The Cells of a run are linked to one another : gather them from the given one
+        const int first = p_cells.size();
+        p_cells.append(p_index);
+        m_segments[p_index * 2 + axis] = -1;
+        for (int i = first; i < p_cells.size(); ++i) {
+            for (int j = 0; j < 4; ++j) {
+                const int next = getNeighbourIndex(p_cells[i], directions[j]);
+                if (next == -1) {
+                    continue;
+                }
+                for (int k = 0; k < 2; ++k) {
+                    if (m_segments[next * 2 + k] == segment) {
+                        m_segments[next * 2 + k] = -1;
+                        p_cells.append(next);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Maze::computeJunctions()
+{
+    const int nbCells = m_nbRows * m_nbColumns;
+
+    // The junctions are the Cells a Character can stand on which do not have exactly two passages
+    m_junctions.fill(-1, nbCells);
+    m_junctionCells.clear();
+    m_junctionEdges.clear();
+    m_junctionEdgeLengths.clear();
+    for (int i = 0; i < nbCells; ++i) {
+        updateJunction(i);
+    }
+    // Follow the corridors leaving each junction up to the next junction
+    for (int i = 0; i < m_junctionCells.size(); ++i) {
+        computeJunctionEdges(i);
+    }
+}
+
+void Maze::updateJunction(const int p_index)
+{
+    const bool isJunction = m_cellTypes[p_index] != Cell::WALL && m_portalExits[p_index] == -1 &&
+                            qPopulationCount((quint8)getPassages(p_index)) != 2;
+    if (isJunction && m_junctions[p_index] == -1) {
+        m_junctions[p_index] = m_junctionCells.size();
+        m_junctionCells.append(p_index);
+        for (int i = 0; i < 4; ++i) {
+            m_junctionEdges.append(-1);
+            m_junctionEdgeLengths.append(0);
+        }
+    } else if (!isJunction && m_junctions[p_index] != -1) {
+        // The junction number is kept unused, so that the other junctions keep theirs
+        const int junction = m_junctions[p_index];
+        m_junctions[p_index] = -1;
+        m_junctionCells[junction] = -1;
+        for (int i = 0; i < 4; ++i) {
+            m_junctionEdges[junction * 4 + i] = -1;
+            m_junctionEdgeLengths[junction * 4 + i] = 0;
+        }
+    }
+}
+
+void Maze::computeJunctionEdges(const int p_junction)
+{
+    static const Direction directions[4] = {UP, RIGHT, DOWN, LEFT};
+
+    const int nbCells = m_nbRows * m_nbColumns;
+
+    if (m_junctionCells[p_junction] == -1) {
+        return;
+    }
+    const int passages = getPassages(m_junctionCells[p_junction]);
+    for (int i = 0; i < 4; ++i) {
+        m_junctionEdges[p_junction * 4 + i] = -1;
+        m_junctionEdgeLengths[p_junction * 4 + i] = 0;
+        if (!(passages & directions[i])) {
+            continue;
+        }
+        int cell = m_junctionCells[p_junction];
+        Direction direction = directions[i];
+        // A loop without any junction is not an edge
+        for (int length = 1; length <= nbCells && direction != NONE; ++length) {
+            cell = followCorridor(cell, direction);
+            if (cell == -1) {
+                break;
+            }
+            if (m_junctions[cell] != -1) {
+                m_junctionEdges[p_junction * 4 + i] = m_junctions[cell];
+                m_junctionEdgeLengths[p_junction * 4 + i] = length;
+                break;
+            }
+        }
+    }
+}
+
+void Maze::collectJunctions(const int p_index, QVector<int> &p_junctions) const
+{
+    static const Direction directions[4] = {UP, RIGHT, DOWN, LEFT};
+
+    const int nbCells = m_nbRows * m_nbColumns;
+
+    if (m_cellTypes[p_index] == Cell::WALL) {
+        return;
+    }
+    const int junction = m_junctions[p_index];
+    if (junction != -1) {
+        p_junctions.append(junction);
+        for (int i = 0; i < 4; ++i) {
+            if (m_junctionEdges[junction * 4 + i] != -1) {
+                p_junctions.append(m_junctionEdges[junction * 4 + i]);
+            }
+        }
+    }
+    // Follow the corridor going through the Cell up to both its ends
+    const int passages = junction == -1 ? getPassages(p_index) : NONE;
+    for (int i = 0; i < 4; ++i) {
+        if (!(passages & directions[i])) {
+            continue;
+        }
+        int cell = p_index;
+        Direction direction = directions[i];
+        for (int length = 1; length <= nbCells && direction != NONE; ++length) {
+            cell = followCorridor(cell, direction);
+            if (cell == -1 || cell == p_index) {
+                break;
+            }
+            if (m_junctions[cell] != -1) {
+                p_junctions.append(m_junctions[cell]);
+                break;
+            }
+        }
+    }
+    // A portal that cannot be taken back leads into the Cell from elsewhere than the corridor ends :
+    // go back along the moves up to the junctions the Cell can be reached from
+    QVector<int> previousCells;
+    previousCells.append(p_index);
+    for (int i = 0; i < previousCells.size(); ++i) {
+        for (int j = m_firstMoves[previousCells[i]]; j < m_firstMoves[previousCells[i] + 1]; ++j) {
+            const int previous = m_moves[j] / 4;
+            if (m_cellTypes[previous] == Cell::WALL || previousCells.contains(previous)) {
+                continue;
+            }
+            if (m_junctions[previous] != -1) {
+                if (!p_junctions.contains(m_junctions[previous])) {
+                    p_junctions.append(m_junctions[previous]);
+                }
+            } else {
+                previousCells.append(previous);
+            }
+        }
+    }
+}
+
+void Maze::computePortals()
+{
+    // The Directions to go to the neighbours of a Cell
+    static const Direction directions[4] = {UP, RIGHT, DOWN, LEFT};
+
+    const int nbCells = m_nbRows * m_nbColumns;
+
+    // Compute the portals : first the tunnels between two opposite borders of the Maze
+    m_portalExits.fill(-1, nbCells);
+    m_portalDirections.fill(NONE, nbCells);
+    for (int i = 0; i < m_nbRows && m_nbColumns > 2; ++i) {
+        const int left = getCellIndex(i, 0);
+        const int right = getCellIndex(i, m_nbColumns - 1);
+        if (m_cellTypes[left] != Cell::WALL && m_cellTypes[right] != Cell::WALL) {
+            setPortalExit(left, right - 1, LEFT);
+            setPortalExit(right, left + 1, RIGHT);
+        }
+    }
+    for (int i = 0; i < m_nbColumns && m_nbRows > 2; ++i) {
+        const int top = getCellIndex(0, i);
+        const int bottom = getCellIndex(m_nbRows - 1, i);
+        if (m_cellTypes[top] != Cell::WALL && m_cellTypes[bottom] != Cell::WALL &&
+                m_portalExits[top] == -1 && m_portalExits[bottom] == -1) {
+            setPortalExit(top, bottom - m_nbColumns, UP);
+            setPortalExit(bottom, top + m_nbColumns, DOWN);
+        }
+    }
+    // Then the portals from the Maze file : mark them first, so that a portal never comes out in another one
+    for (int i = 0; i < m_portals.size(); ++i) {
+        m_portalExits[m_portals[i].first] = m_portals[i].first;
+        m_portalExits[m_portals[i].second] = m_portals[i].second;
+    }
+    for (int i = 0; i < m_portals.size(); ++i) {
+        for (int j = 0; j < 2; ++j) {
+            const int entrance = j == 0 ? m_portals[i].first : m_portals[i].second;
+            const int other = j == 0 ? m_portals[i].second : m_portals[i].first;
+            // Come out on the first Cell next to the other end that is neither a wall nor a portal
+            int k = 0;
+            while (k < 4) {
+                const int exit = getAdjacentIndex(other, directions[k]);
+                if (exit != -1 && m_cellTypes[exit] != Cell::WALL && m_portalExits[exit] == -1) {
+                    break;
+                }
+                ++k;
+            }
+            if (k < 4) {
+                setPortalExit(entrance, getAdjacentIndex(other, directions[k]), directions[k]);
+            } else {
+                qCritical() << "Portal without exit";
+                setPortalExit(entrance, -1, NONE);
+            }
+        }
+    }
+}
+
+void Maze::computeNeighbours(const int p_index)
+{
+    static const Direction directions[4] = {UP, RIGHT, DOWN, LEFT};
+
+    for (int i = 0; i < 4; ++i) {
+        const int next = getAdjacentIndex(p_index, directions[i]);
+        if (next != -1 && m_portalExits[next] != -1 && m_portalExits[next] != next) {
+            m_neighbours[p_index * 4 + i] = m_portalExits[next];
+        } else {
+            m_neighbours[p_index * 4 + i] = next;
+        }
+    }
+}
+
+void Maze::computeMoves()
+{
+    const int nbCells = m_nbRows * m_nbColumns;
+
+    // List the moves leading to each Cell, since a portal may lead to a Cell from which it cannot be taken back
+    m_firstMoves.fill(0, nbCells + 1);
+    m_moves.resize(nbCells * 4);
+    for (int i = 0; i < nbCells * 4; ++i) {
+        if (m_neighbours[i] != -1) {
+            ++m_firstMoves[m_neighbours[i] + 1];
+        }
+    }
+    for (int i = 0; i < nbCells; ++i) {
+        m_firstMoves[i + 1] += m_firstMoves[i];
+    }
+    QVector<int> nextMove = m_firstMoves;
+    for (int i = 0; i < nbCells * 4; ++i) {
+        if (m_neighbours[i] != -1) {
+            m_moves[nextMove[m_neighbours[i]]++] = i;
+        }
+    }
+}
+
+void Maze::computeCampDistances()
+{
+    static const Direction directions[4] = {UP, RIGHT, DOWN, LEFT};
+
+    const int nbCells = m_nbRows * m_nbColumns;
+
+    // Compute the way to the Ghost camp with a breadth-first search from the resurrection Cell, going backwards along the moves
+    const int target = getCellIndex(m_resurrectionCell.y(), m_resurrectionCell.x());
+    QVector<int> queue;
+    queue.reserve(nbCells);
+    m_campDistances.fill(-1, nbCells);
+    m_campDirections.fill(NONE, nbCells);
+    m_campDistances[target] = 0;
+    queue.append(target);
+    for (int i = 0; i < queue.size(); ++i) {
+        for (int j = m_firstMoves[queue[i]]; j < m_firstMoves[queue[i] + 1]; ++j) {
+            const int previous = m_moves[j] / 4;
+            if (m_cellTypes[previous] != Cell::WALL && m_campDistances[previous] == -1) {
+                m_campDistances[previous] = m_campDistances[queue[i]] + 1;
+                m_campDirections[previous] = directions[m_moves[j] % 4];
+                queue.append(previous);
+            }
+        }
+    }
+}
+
+void Maze::computeExits(const int p_index)
+{
+    static const Direction directions[4] = {UP, RIGHT, DOWN, LEFT};
+
+    m_exits[p_index] = NONE;
+    m_ghostExits[p_index] = NONE;
+    for (int i = 0; i < 4; ++i) {
+        const int next = m_neighbours[p_index * 4 + i];
+        if (next == -1) {
+            continue;
+        }
+        if (m_cellTypes[next] == Cell::CORRIDOR) {
+            m_exits[p_index] |= directions[i];
+            m_ghostExits[p_index] |= directions[i];
+        } else if (m_cellTypes[p_index] == Cell::GHOSTCAMP && m_cellTypes[next] == Cell::GHOSTCAMP) {
+            m_ghostExits[p_index] |= directions[i];
+        }
+    }
+}
+
+void Maze::changeCellType(const int p_index, const Cell::Type p_type)
+{
+    static const Direction directions[4] = {UP, RIGHT, DOWN, LEFT};
+
+    if (m_cellTypes[p_index] == p_type) {
+        return;
+    }
+    // A Cell on a border or next to a portal of the Maze file may open, close or move a portal :
+    // compute the portals again, and list the changed portals and the Cells next to them, whose neighbours change
+    QVector<int> portalExits;
+    QVector<quint8> portalDirections;
+    QVector<int> rewiredCells;
+    if (isNearPortal(p_index)) {
+        const quint8 oldType = m_cellTypes[p_index];
+        m_cellTypes[p_index] = p_type;
+        portalExits = m_portalExits;
+        portalDirections = m_portalDirections;
+        computePortals();
+        m_cellTypes[p_index] = oldType;
+        for (int i = 0; i < m_nbRows * m_nbColumns; ++i) {
+            if (m_portalExits[i] != portalExits[i] || m_portalDirections[i] != portalDirections[i]) {
+                if (!rewiredCells.contains(i)) {
+                    rewiredCells.append(i);
+                }
+                for (int j = 0; j < 4; ++j) {
+                    const int next = getAdjacentIndex(i, directions[j]);
+                    if (next != -1 && !rewiredCells.contains(next)) {
+                        rewiredCells.append(next);
+                    }
+                }
+            }
+        }
+        // Keep the old portals until the old corridors have been unlabelled
+        m_portalExits.swap(portalExits);
+        m_portalDirections.swap(portalDirections);
+    }
+
+    // The Cells whose passages change : the changed Cell, the ones it can be reached from, and the rewired ones
+    QVector<int> cells;
+    cells.append(p_index);
+    for (int i = m_firstMoves[p_index]; i < m_firstMoves[p_index + 1]; ++i) {
+        cells.append(m_moves[i] / 4);
+    }
+    for (int i = 0; i < rewiredCells.size(); ++i) {
+        if (!cells.contains(rewiredCells[i])) {
+            cells.append(rewiredCells[i]);
+        }
+    }
+
+    // Before the change, gather the junctions whose corridors go through these Cells, and unlabel their runs
+    QVector<int> junctions;
+    QVector<int> segmentCells;
+    for (int i = 0; i < cells.size(); ++i) {
+        collectJunctions(cells[i], junctions);
+        clearSegments(cells[i], segmentCells);
+    }
+
+    m_cellTypes[p_index] = p_type;
+    if (!rewiredCells.isEmpty()) {
+        m_portalExits.swap(portalExits);
+        m_portalDirections.swap(portalDirections);
+        for (int i = 0; i < rewiredCells.size(); ++i) {
+            computeNeighbours(rewiredCells[i]);
+        }
+        computeMoves();
+    }
+
+    for (int i = 0; i < cells.size(); ++i) {
+        computeExits(cells[i]);
+        updateJunction(cells[i]);
+    }
+    for (int i = 0; i < cells.size(); ++i) {
+        collectJunctions(cells[i], junctions);
+    }
+    for (int i = 0; i < junctions.size(); ++i) {
+        computeJunctionEdges(junctions[i]);
+    }
+    labelSegments(p_index);
+    for (int i = 0; i < segmentCells.size(); ++i) {
+        labelSegments(segmentCells[i]);
+    }
+    // A portal change may shorten or cut the way to the Ghost camp anywhere in the Maze
+    if (rewiredCells.isEmpty()) {
+        repairCampDistances(p_index);
+    } else {
+        computeCampDistances();
+    }
+    if (m_clusterGraph) {
+        m_clusterGraph->update(p_index);
+        for (int i = 0; i < rewiredCells.size(); ++i) {
+            m_clusterGraph->update(rewiredCells[i]);
+        }
+    }
+}
+
+bool Maze::isNearPortal(const int p_index) const
+{
+    const int row = getRowFromIndex(p_index);
+    const int column = getColumnFromIndex(p_index);
+    if (row == 0 || row == m_nbRows - 1 || column == 0 || column == m_nbColumns - 1) {
+        return true;
+    }
+    for (int i = 0; i < m_portals.size(); ++i) {
+        for (int j = 0; j < 2; ++j) {
+            const int end = j == 0 ? m_portals[i].first : m_portals[i].second;
+            if (qAbs(getRowFromIndex(end) - row) + qAbs(getColumnFromIndex(end) - column) <= 1) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void Maze::repairCampDistances(const int p_index)
+{
+    static const Direction directions[4] = {UP, RIGHT, DOWN, LEFT};
+
+    // The Cells whose distance is to be computed again, with the distance they can already get from their neighbours
+    QVector<QPair<int, int> > openList;
+    if (m_cellTypes[p_index] == Cell::WALL) {
+        // The Cells whose way went through the closed Cell lose their distance
+        QVector<int> lost;
+        lost.append(p_index);
+        for (int i = 0; i < lost.size(); ++i) {
+            for (int j = m_firstMoves[lost[i]]; j < m_firstMoves[lost[i] + 1]; ++j) {
+                const int previous = m_moves[j] / 4;
+                if (m_campDistances[previous] != -1 && m_campDirections[previous] == directions[m_moves[j] % 4]) {
+                    m_campDistances[previous] = -1;
+                    lost.append(previous);
+                }
+            }
+        }
+        m_campDistances[p_index] = -1;
+        m_campDirections[p_index] = NONE;
+        for (int i = 1; i < lost.size(); ++i) {
+            m_campDirections[lost[i]] = NONE;
+            int distance = -1;
+            for (int j = 0; j < 4; ++j) {
+                const int next = m_neighbours[lost[i] * 4 + j];
+                if (next != -1 && m_cellTypes[next] != Cell::WALL && m_campDistances[next] != -1 &&
+                        (distance == -1 || m_campDistances[next] + 1 < distance)) {
+                    distance = m_campDistances[next] + 1;
+                }
+            }
+            if (distance != -1) {
+                openList.append(qMakePair(distance, lost[i]));
+            }
+        }
+    } else {
+        // The opened Cell gets its distance from its neighbours
+        for (int j = 0; j < 4; ++j) {
+            const int next = m_neighbours[p_index * 4 + j];
+            if (next != -1 && m_cellTypes[next] != Cell::WALL && m_campDistances[next] != -1) {
+                openList.append(qMakePair(m_campDistances[next] + 1, p_index));
+            }
+        }
+    }
+    std::make_heap(openList.begin(), openList.end(), std::greater<QPair<int, int> >());
+
+    // Spread the new distances, the shortest first, as long as they improve the ones of the Cells
+    while (!openList.isEmpty()) {
+        std::pop_heap(openList.begin(), openList.end(), std::greater<QPair<int, int> >());
+        const QPair<int, int> current = openList.takeLast();
+        const int cell = current.second;
+        if (m_campDistances[cell] != -1 && m_campDistances[cell] <= current.first) {
+            continue;
+        }
+        m_campDistances[cell] = current.first;
+        for (int j = 0; j < 4; ++j) {
+            const int next = m_neighbours[cell * 4 + j];
+            if (next != -1 && m_cellTypes[next] != Cell::WALL && m_campDistances[next] == current.first - 1) {
+                m_campDirections[cell] = directions[j];
+                break;
+            }
+        }
+        for (int j = m_firstMoves[cell]; j < m_firstMoves[cell + 1]; ++j) {
+            const int previous = m_moves[j] / 4;
+            if (m_cellTypes[previous] != Cell::WALL &&
+                    (m_campDistances[previous] == -1 || m_campDistances[previous] > current.first + 1)) {
+                openList.append(qMakePair(current.first + 1, previous));
+                std::push_heap(openList.begin(), openList.end(), std::greater<QPair<int, int> >());
+            }
+        }
+    }
+}
+
+void Maze::setPortalExit(const int p_index, const int p_exit, const Direction p_direction)
+{
+    m_portalExits[p_index] = p_exit;
+    m_portalDirections[p_index] = p_direction;
+}
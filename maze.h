@@ -23,7 +23,11 @@
 
 #include <QObject>
 #include <QList>
+#include <QPair>
 #include <QPoint>
+#include <QVector>
+
+class ClusterGraph;
 
 /**
  * @brief This class represents the Maze of the game.
@@ -33,6 +37,30 @@ class Maze : public QObject
 
     Q_OBJECT
 
+public:
+
+    /** The directions to go from a Cell to one of its neighbours, as bits so that they can be combined in exit masks */
+    enum Direction {
+        NONE = 0,
+        UP = 1,
+        RIGHT = 2,
+        DOWN = 4,
+        LEFT = 8
+    };
+
+    /** The things a Cell can hold for the Kapman to eat, stored on one byte */
+    enum Consumable {
+        NO_CONSUMABLE = 0,
+        PILL = 1,
+        ENERGIZER = 2
+    };
+
+    /**
+     * The number of Cells from which the paths are searched with the hierarchical A* algorithm.
+     * Below it, kapman-sim --benchmark hierarchy shows the hierarchical search is no faster than the PathFinder.
+     */
+    static const int HIERARCHICAL_MIN_CELLS;
+
 private:
 
     /** The Cell coordinates where the Ghosts go back when they have been eaten */
@@ -44,14 +72,71 @@ private:
     /** The number of columns of the Maze */
     int m_nbColumns;
 
-    /** The Maze Cells */
-    Cell **m_cells;
+    /** The type of each Cell of the Maze, row after row, stored on one byte */
+    QVector<quint8> m_cellTypes;
+
+    /** For each Cell, the Consumable it holds at the beginning of a level, row after row, stored on one byte */
+    QVector<quint8> m_consumables;
 
-    /** The initial number of Elements in the Maze (when the game has not started) */
+    /** The number of Consumables the Maze holds at the beginning of a level */
     int m_totalNbElem;
 
-    /** The number of remaining Elements in the Maze (when the game is running) */
-    int m_nbElem;
+    /** For each Cell, the number of moves needed to reach the resurrection Cell, -1 if it cannot be reached */
+    QVector<int> m_campDistances;
+
+    /** For each Cell, the Direction of the next move to reach the resurrection Cell */
+    QVector<quint8> m_campDirections;
+
+    /** The pairs of Cells linked by a portal declared in the Maze file, as Cell indexes */
+    QVector<QPair<int, int> > m_portals;
+
+    /** For each Cell, the index of the Cell where a Character entering it comes out of a portal, -1 if the Cell is not a portal */
+    QVector<int> m_portalExits;
+
+    /** For each portal Cell, the Direction a Character has when it comes out of the portal */
+    QVector<quint8> m_portalDirections;
+
+    /** For each Cell, the indexes of its neighbours in the 4 Directions once the portals have been taken, -1 if there is none */
+    QVector<int> m_neighbours;
+
+    /** For each Cell, the position of the first move leading to it in m_moves, plus the end of the last Cell */
+    QVector<int> m_firstMoves;
+
+    /** The moves leading to each Cell, one Cell after the other, as the position of the move in m_neighbours */
+    QVector<int> m_moves;
+
+    /** For each corridor Cell, the straight corridor run it belongs to along each axis (horizontal, then vertical), -1 if there is none */
+    QVector<int> m_segments;
+
+    /** For each corridor Cell, its position along the runs it belongs to */
+    QVector<int> m_segmentPositions;
+
+    /** For each corridor Cell, the Direction along which the positions of its runs increase */
+    QVector<quint8> m_segmentDirections;
+
+    /** For each run, whether it loops on itself through a portal */
+    QVector<bool> m_cyclicSegments;
+
+    /** The hierarchical path finding graph, only built for the large Mazes, else 0 */
+    ClusterGraph *m_clusterGraph;
+
+    /** For each Cell, its junction number, -1 if the Cell is not a junction */
+    QVector<int> m_junctions;
+
+    /** For each junction, the index of its Cell */
+    QVector<int> m_junctionCells;
+
+    /** For each junction, the junctions reached by following the corridor in each of the 4 Directions, -1 if there is none */
+    QVector<int> m_junctionEdges;
+
+    /** For each junction, the length of the corridor followed in each of the 4 Directions */
+    QVector<int> m_junctionEdgeLengths;
+
+    /** For each Cell, the mask of the Directions leading to a corridor Cell */
+    QVector<quint8> m_exits;
+
+    /** For each Cell, the mask of the Directions a Ghost can take : the corridor exits, plus the exits to other camp Cells inside the Ghost camp */
+    QVector<quint8> m_ghostExits;
 
 public:
 
@@ -72,6 +157,14 @@ public:
      */
     void init(const int p_nbRows, const int p_nbColumns);
 
+    /**
+     * Computes the data derived from the Cells, once all of them have been set :
+     * the portals and the neighbours of each Cell, the way to go to the Ghost camp and the exit masks.
+     * A non wall Cell on a Maze border whose opposite border Cell is not a wall either becomes a portal
+     * (the left and right, or top and bottom, tunnels), in addition to the portals added with addPortal().
+     */
+    void prepare();
+
     /**
      * Sets the CellType of the Cell whose coordinates are given in parameters.
      * @param p_row the Cell row
@@ -81,66 +174,285 @@ public:
     void setCellType(const int p_row, const int p_column, const Cell::Type p_type);
 
     /**
-     * Sets the Element that is on the Cell whose coordinates are given in parameters.
+     * Sets the Consumable the Cell whose coordinates are given in parameters holds at the beginning of a level.
      * @param p_row the Cell row
      * @param p_column the Cell column
-     * @param p_element the Element that is on the Cell
+     * @param p_consumable the Consumable the Cell holds
      */
-    void setCellElement(const int p_row, const int p_column, Element *p_element);
+    void setConsumable(const int p_row, const int p_column, const Consumable p_consumable);
 
     /**
-     * Sets the cell on witch the ghosts resurrect from prey state
-     * @param p_resurrectionCell the cell on witch the ghosts resurrect
+     * Opens a Cell during the game : the Cell becomes a corridor.
+     * The data derived from the Cells is repaired around the Cell only, see closeCell().
+     * @param p_row the row index of the Cell
+     * @param p_column the column index of the Cell
      */
-    void setResurrectionCell(QPoint p_resurrectionCell);
+    void openCell(const int p_row, const int p_column);
 
     /**
-     * Decrements the number of remaining Elements.
+     * Closes a Cell during the game : the Cell becomes a wall.
+     * Rather than computing again the data derived from the Cells, it is repaired around the Cell only :
+     * the exit masks, the corridor runs and the junctions of the neighbourhood, and the way to the Ghost camp
+     * of the Cells whose way went through the Cell. On a border or next to a portal of the Maze file, the Cell may
+     * open, close or move a portal : the portals, the moves and the way to the Ghost camp are then computed again.
+     * @param p_row the row index of the Cell
+     * @param p_column the column index of the Cell
      */
-    void decrementNbElem();
+    void closeCell(const int p_row, const int p_column);
 
     /**
-     * Resets the number of remaining Elements to the initial number.
+     * Links two Cells with a portal : a Character entering one of them comes out next to the other one.
+     * @param p_row the row index of the first Cell
+     * @param p_column the column index of the first Cell
+     * @param p_otherRow the row index of the second Cell
+     * @param p_otherColumn the column index of the second Cell
      */
-    void resetNbElem();
+    void addPortal(const int p_row, const int p_column, const int p_otherRow, const int p_otherColumn);
+
+    /**
+     * Sets the cell on witch the ghosts resurrect from prey state
+     * @param p_resurrectionCell the cell on witch the ghosts resurrect
+     */
+    void setResurrectionCell(QPoint p_resurrectionCell);
 
     /**
      * Gets the path, as a list of Cell coordinates, to go to the Ghost camp from the Cell whose coordinates are given in parameters.
-     * This algorithm has been made from the A* algorithm.
      * @param p_row the row index of the starting Cell
      * @param p_column the column index of the starting Cell
-     * @return a list of Cell coordinates to go to the Ghost camp
+     * @return a list of Cell coordinates to go to the Ghost camp, the starting Cell excluded
+     * @see findPath()
      */
     QList<QPoint> getPathToGhostCamp(const int p_row, const int p_column) const;
 
     /**
-     * Gets the Cell at the given coordinates.
+     * Gets a path, as a list of Cell coordinates, between two Cells.
+     * The shortest path is searched with the A* algorithm, see PathFinder, unless the Maze has at least
+     * HIERARCHICAL_MIN_CELLS Cells : a nearly shortest path is then searched with the hierarchical A* algorithm, see ClusterGraph.
+     * The Maze is not modified, so several paths can be computed at the same time.
+     * @param p_fromRow the row index of the starting Cell
+     * @param p_fromColumn the column index of the starting Cell
+     * @param p_toRow the row index of the target Cell
+     * @param p_toColumn the column index of the target Cell
+     * @return a list of Cell coordinates to go to the target Cell, the starting Cell excluded, empty if the target Cell cannot be reached
+     */
+    QList<QPoint> findPath(const int p_fromRow, const int p_fromColumn, const int p_toRow, const int p_toColumn) const;
+
+    /**
+     * Gets the Direction to follow from the given Cell to go to the Ghost camp.
+     * This is a simple lookup in a table computed by prepare().
+     * @param p_row the row index of the Cell
+     * @param p_column the column index of the Cell
+     * @return the Direction of the next move, NONE if the Cell is the resurrection Cell or if the camp cannot be reached
+     */
+    Direction getDirectionToGhostCamp(const int p_row, const int p_column) const;
+
+    /**
+     * Gets the Directions leading from the given Cell to a corridor Cell.
+     * @param p_row the row index of the Cell
+     * @param p_column the column index of the Cell
+     * @return the mask of the Directions the Kapman can take from the Cell
+     */
+    int getExits(const int p_row, const int p_column) const;
+
+    /**
+     * Gets the Directions a Ghost can take from the given Cell.
+     * Unlike getExits(), they include the moves between two Cells of the Ghost camp.
+     * @param p_row the row index of the Cell
+     * @param p_column the column index of the Cell
+     * @return the mask of the Directions a Ghost can take from the Cell
+     */
+    int getGhostExits(const int p_row, const int p_column) const;
+
+    /**
+     * Gets the number of moves needed to go to the Ghost camp from the given Cell.
+     * @param p_row the row index of the Cell
+     * @param p_column the column index of the Cell
+     * @return the number of moves to the resurrection Cell, -1 if it cannot be reached
+     */
+    int getDistanceToGhostCamp(const int p_row, const int p_column) const;
+
+    /**
+     * Gets the type of the Cell at the given coordinates.
+     * @param p_row the row index
+     * @param p_column the column index
+     * @return the type of the Cell at the given row and column, Cell::WALL if it is outside of the Maze
+     */
+    Cell::Type getCellType(const int p_row, const int p_column) const;
+
+    /**
+     * Gets the type of the Cell at the given index.
+     * @param p_index the Cell index, see getCellIndex()
+     * @return the type of the Cell
+     */
+    Cell::Type getCellType(const int p_index) const;
+
+    /**
+     * Gets the Consumable the Cell at the given index holds at the beginning of a level.
+     * @param p_index the Cell index
+     * @return the Consumable the Cell holds
+     */
+    Consumable getConsumable(const int p_index) const;
+
+    /**
+     * @return for each Cell, the Consumable it holds at the beginning of a level, row after row
+     */
+    const QVector<quint8> &getConsumables() const;
+
+    /**
+     * Gets the index of the Cell at the given coordinates.
+     * The Cells are numbered row after row, from 0 to getNbRows() * getNbColumns() - 1.
      * @param p_row the row index
      * @param p_column the column index
-     * @return the Cell at the given row and column
+     * @return the Cell index
+     */
+    int getCellIndex(const int p_row, const int p_column) const;
+
+    /**
+     * Gets the row of the Cell at the given index.
+     * @param p_index the Cell index
+     * @return the row index of the Cell
+     */
+    int getRowFromIndex(const int p_index) const;
+
+    /**
+     * Gets the column of the Cell at the given index.
+     * @param p_index the Cell index
+     * @return the column index of the Cell
+     */
+    int getColumnFromIndex(const int p_index) const;
+
+    /**
+     * Gets the coordinates of the Cell at the given index as a QPoint.
+     * @param p_index the Cell index
+     * @return the column (x) and row (y) of the Cell
+     */
+    QPoint getCoords(const int p_index) const;
+
+    /**
+     * Gets the index of the neighbour of a Cell in the given Direction.
+     * If the adjacent Cell is a portal, the neighbour is the Cell where a Character comes out of the portal.
+     * @param p_index the Cell index
+     * @param p_direction the Direction of the neighbour
+     * @return the neighbour Cell index, -1 if there is none
+     */
+    int getNeighbourIndex(const int p_index, const Direction p_direction) const;
+
+    /**
+     * Gets the Cells whose neighbour a Cell is, in any Direction.
+     * Through a portal, a Cell may lead to a neighbour which does not lead back to it.
+     * @param p_index the Cell index
+     * @param p_cells is set to the Cell indexes, a Cell appearing once for each Direction leading to the given Cell
+     */
+    void getPreviousCells(const int p_index, QVector<int> &p_cells) const;
+
+    /**
+     * Gets the Cell where a Character entering the given Cell comes out of a portal.
+     * @param p_row the row index of the Cell
+     * @param p_column the column index of the Cell
+     * @return the index of the Cell where the Character comes out, -1 if the given Cell is not a portal
      */
-    Cell getCell(const int p_row, const int p_column) const;
+    int getPortalExit(const int p_row, const int p_column) const;
 
     /**
-     * Gets the coordinates of the given Cell as a QPoint.
-     * @param p_cell the searched Cell
-     * @return the row and column of the given Cell
+     * Gets the Direction a Character entering the given portal Cell has when it comes out of the portal.
+     * @param p_row the row index of the portal Cell
+     * @param p_column the column index of the portal Cell
+     * @return the Direction the Character has when it comes out, NONE if the given Cell is not a portal
      */
-    QPoint getCoords(Cell *p_cell) const;
+    Direction getPortalDirection(const int p_row, const int p_column) const;
+
+    /**
+     * Gets the mask of the Directions leading from a Cell to a Cell which is not a wall,
+     * i.e. the moves taken into account to find paths.
+     * @param p_index the Cell index
+     * @return the mask of the Directions leading to a Cell which is not a wall
+     */
+    int getPassages(const int p_index) const;
+
+    /**
+     * Gets the junction number of a Cell. The junctions are the Cells which do not have exactly two passages :
+     * the crossroads and the dead ends. They are the nodes of the junction graph, whose edges are the corridors linking them.
+     * @param p_index the Cell index
+     * @return the junction number, -1 if the Cell is not a junction
+     */
+    int getJunction(const int p_index) const;
+
+    /**
+     * Gets the number of junctions of the Maze, including the ones which are no longer used since a Cell has been opened or closed.
+     * @return the number of junctions
+     */
+    int getNbJunctions() const;
+
+    /**
+     * Gets the Cell of a junction.
+     * @param p_junction the junction number
+     * @return the Cell index, -1 if the junction is no longer used
+     */
+    int getJunctionCell(const int p_junction) const;
+
+    /**
+     * Gets the junction reached by following the corridor leaving a junction in the given Direction.
+     * @param p_junction the junction number
+     * @param p_direction the Direction of the corridor
+     * @return the junction number, -1 if there is no corridor in this Direction or if it does not lead to a junction
+     */
+    int getJunctionEdge(const int p_junction, const Direction p_direction) const;
+
+    /**
+     * Gets the length of the corridor leaving a junction in the given Direction.
+     * @param p_junction the junction number
+     * @param p_direction the Direction of the corridor
+     * @return the number of moves needed to reach the next junction
+     */
+    int getJunctionEdgeLength(const int p_junction, const Direction p_direction) const;
+
+    /**
+     * Moves one Cell along a corridor.
+     * @param p_index the index of the Cell to move from
+     * @param p_direction the Direction of the move, replaced by the Direction to go on with along the corridor,
+     * or by the Direction after the move if the reached Cell is a junction
+     * @return the index of the reached Cell
+     */
+    int followCorridor(const int p_index, Direction &p_direction) const;
+
+    /**
+     * Checks whether the Maze contains portals.
+     * @return true if at least one Cell is a portal
+     */
+    bool hasPortals() const;
+
+    /**
+     * Checks whether a Cell can be seen from another Cell when looking in the given Direction,
+     * i.e. both lie on the same straight corridor run, the portals included, with the second one ahead.
+     * @param p_fromRow the row index of the Cell to look from
+     * @param p_fromColumn the column index of the Cell to look from
+     * @param p_direction the Direction to look in
+     * @param p_toRow the row index of the Cell to look at
+     * @param p_toColumn the column index of the Cell to look at
+     * @return true if the second Cell is in the line of sight
+     */
+    bool isInLineSight(const int p_fromRow, const int p_fromColumn, const Direction p_direction, const int p_toRow, const int p_toColumn) const;
+
+    /**
+     * Gets the Direction opposite to the given one.
+     * @param p_direction a Direction
+     * @return the opposite Direction, NONE if the given Direction is NONE
+     */
+    static Direction getOppositeDirection(const Direction p_direction);
 
     /**
      * Gets the row index corresponding to the given y-coordinate.
-     * @param p_y the y-coordinate to convert into row index
+     * @param p_y the y-coordinate to convert into row index, in Cell::SUBCELLS units per Cell, which must not be negative
      * @return the row index corresponding to the given y-coordinate
      */
-    int getRowFromY(const qreal p_y) const;
+    static int getRowFromY(const int p_y);
 
     /**
      * Gets the column index corresponding to the given x-coordinate.
-     * @param p_x the x-coordinate to convert into column index
+     * @param p_x the x-coordinate to convert into column index, in Cell::SUBCELLS units per Cell, which must not be negative
      * @return the column index corresponding to the given x-coordinate
      */
-    int getColFromX(const qreal p_x) const;
+    static int getColFromX(const int p_x);
 
     /**
      * Gets the number of columns of the Maze.
@@ -155,14 +467,8 @@ public:
     int getNbRows() const;
 
     /**
-     * Gets the number of remaining Elements still on the Maze.
-     * @return the number of remaining Elements
-     */
-    int getNbElem() const;
-
-    /**
-     * Gets the number of Elements initially on the Maze.
-     * @return the initial number of Elements
+     * Gets the number of Consumables the Maze holds at the beginning of a level.
+     * @return the initial number of Consumables
      */
     int getTotalNbElem() const;
 
@@ -172,12 +478,121 @@ public:
      */
     QPoint getResurrectionCell() const;
 
-signals:
+private:
+
+    /**
+     * Gets the index of the Cell adjacent to a Cell in the given Direction, not taking the portals into account.
+     * @param p_index the Cell index
+     * @param p_direction the Direction of the adjacent Cell
+     * @return the adjacent Cell index, -1 if it is outside of the Maze
+     */
+    int getAdjacentIndex(const int p_index, const Direction p_direction) const;
+
+    /**
+     * Makes a Character entering a Cell come out in another Cell.
+     * @param p_index the index of the portal Cell
+     * @param p_exit the index of the Cell where the Character comes out
+     * @param p_direction the Direction the Character has when it comes out
+     */
+    void setPortalExit(const int p_index, const int p_exit, const Direction p_direction);
+
+    /**
+     * Gets the Direction a Character has once it has moved from a Cell in the given Direction,
+     * which changes when the Character goes through a portal.
+     * @param p_index the Cell index
+     * @param p_direction the Direction of the move
+     * @return the Direction after the move
+     */
+    Direction getDirectionAfterMove(const int p_index, const Direction p_direction) const;
+
+    /**
+     * Labels the corridor Cells with the straight corridor runs they belong to.
+     */
+    void computeSegments();
+
+    /**
+     * Labels a corridor Cell, and the Cells of its runs, with the runs it belongs to if it is not labelled yet.
+     * @param p_index the Cell index
+     */
+    void labelSegments(const int p_index);
+
+    /**
+     * Removes the labels of the runs a Cell belongs to from all the Cells of these runs.
+     * @param p_index the Cell index
+     * @param p_cells the list to add the unlabelled Cells to
+     */
+    void clearSegments(const int p_index, QVector<int> &p_cells);
+
+    /**
+     * Computes the junction graph : the junctions and the corridors linking them.
+     */
+    void computeJunctions();
+
+    /**
+     * Makes a Cell a junction, or no longer a junction, according to its passages.
+     * @param p_index the Cell index
+     */
+    void updateJunction(const int p_index);
+
+    /**
+     * Follows the corridors leaving a junction up to the next junctions.
+     * @param p_junction the junction number
+     */
+    void computeJunctionEdges(const int p_junction);
+
+    /**
+     * Adds to a list the junctions whose corridors go through a Cell.
+     * @param p_index the Cell index
+     * @param p_junctions the list to add the junctions to
+     */
+    void collectJunctions(const int p_index, QVector<int> &p_junctions) const;
+
+    /**
+     * Computes the portals from the Cell types : the tunnels between two opposite borders, and the portals of the Maze file.
+     */
+    void computePortals();
+
+    /**
+     * Computes the neighbours of a Cell, going through the portals.
+     * @param p_index the Cell index
+     */
+    void computeNeighbours(const int p_index);
+
+    /**
+     * Lists the moves leading to each Cell from the neighbours.
+     */
+    void computeMoves();
+
+    /**
+     * Computes the way to the Ghost camp of every Cell.
+     */
+    void computeCampDistances();
+
+    /**
+     * Checks whether changing the type of a Cell may change the portals.
+     * @param p_index the Cell index
+     * @return true if the Cell is on a border of the Maze or next to a portal of the Maze file
+     */
+    bool isNearPortal(const int p_index) const;
+
+    /**
+     * Computes the exit masks of a Cell.
+     * @param p_index the Cell index
+     */
+    void computeExits(const int p_index);
+
+    /**
+     * Changes the type of a Cell during the game, and repairs the data derived from the Cells.
+     * @param p_index the Cell index
+     * @param p_type the new Cell type
+     */
+    void changeCellType(const int p_index, const Cell::Type p_type);
 
     /**
-     * Emitted when all the elements on the Maze have been eaten.
+     * Repairs the way to the Ghost camp once a Cell has been opened or closed.
+     * @param p_index the index of the changed Cell
      */
-    void allElementsEaten();
+    void repairCampDistances(const int p_index);
 };
 
 #endif
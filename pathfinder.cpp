@@ -0,0 +1,301 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pathfinder.h"
+#include "maze.h"
+
+#include <stdlib.h>
+
+PathFinder::PathFinder() : m_generation(0)
+{
+
+}
+
+PathFinder::~PathFinder()
+{
+
+}
+
+QList<QPoint> PathFinder::findPath(const Maze *p_maze, const int p_fromRow, const int p_fromColumn, const int p_toRow, const int p_toColumn)
+{
+    // The 4 Directions enabling to go from a Cell to its neighbours
+    static const Maze::Direction directions[4] = {Maze::LEFT, Maze::RIGHT, Maze::UP, Maze::DOWN};
+
+    QList<QPoint> path;
+    const int start = p_maze->getCellIndex(p_fromRow, p_fromColumn);
+    const int target = p_maze->getCellIndex(p_toRow, p_toColumn);
+    if (start == target || p_maze->getCellType(start) == Cell::WALL || p_maze->getCellType(target) == Cell::WALL) {
+        return path;
+    }
+    // Through a portal, the Manhattan distance may overestimate the remaining cost : fall back to Dijkstra
+    const bool useHeuristic = !p_maze->hasPortals();
+
+    initSearch(p_maze->getNbJunctions());
+    // The search runs on the junction graph : the target is reached from the junctions at the ends of its corridor
+    int targetJunctions[4];
+    int targetLengths[4];
+    int nbTargetJunctions = 0;
+    if (p_maze->getJunction(target) != -1) {
+        targetJunctions[0] = p_maze->getJunction(target);
+        targetLengths[0] = 0;
+        nbTargetJunctions = 1;
+    } else {
+        for (int i = 0; i < 4; ++i) {
+            if (!(p_maze->getPassages(target) & directions[i])) {
+                continue;
+            }
+            Maze::Direction direction = directions[i];
+            int cell = target;
+            for (int length = 1; length <= p_maze->getNbRows() * p_maze->getNbColumns(); ++length) {
+                cell = p_maze->followCorridor(cell, direction);
+                if (cell == -1 || cell == target) {
+                    break;
+                }
+                if (p_maze->getJunction(cell) != -1) {
+                    targetJunctions[nbTargetJunctions] = p_maze->getJunction(cell);
+                    targetLengths[nbTargetJunctions] = length;
+                    ++nbTargetJunctions;
+                    break;
+                }
+            }
+        }
+    }
+
+    // The start is linked to the junctions at the ends of its corridor, unless the target lies on the way
+    int bestCost = -1;
+    int bestJunction = -1;
+    Maze::Direction bestDirection = Maze::NONE;
+    if (p_maze->getJunction(start) != -1) {
+        addStart(p_maze, p_maze->getJunction(start), 0, Maze::NONE, p_toRow, p_toColumn, useHeuristic);
+    } else {
+        for (int i = 0; i < 4; ++i) {
+            if (!(p_maze->getPassages(start) & directions[i])) {
+                continue;
+            }
+            Maze::Direction direction = directions[i];
+            int cell = start;
+            for (int length = 1; length <= p_maze->getNbRows() * p_maze->getNbColumns(); ++length) {
+                cell = p_maze->followCorridor(cell, direction);
+                if (cell == -1 || cell == start) {
+                    break;
+                }
+                if (cell == target) {
+                    if (bestCost == -1 || length < bestCost) {
+                        bestCost = length;
+                        bestDirection = directions[i];
+                    }
+                    break;
+                }
+                if (p_maze->getJunction(cell) != -1) {
+                    addStart(p_maze, p_maze->getJunction(cell), length, directions[i], p_toRow, p_toColumn, useHeuristic);
+                    break;
+                }
+            }
+        }
+    }
+
+    // While there are junctions left to explore which may lead to a shorter path
+    while (!m_openList.isEmpty()) {
+        // Switch the lowest cost junction to the closed list
+        const Node current = popNode();
+        if (m_closed[current.index] == m_generation) {
+            // This junction has already been reached through a shorter path
+            continue;
+        }
+        if (bestCost != -1 && current.cost >= bestCost) {
+            break;
+        }
+        m_closed[current.index] = m_generation;
+        for (int i = 0; i < nbTargetJunctions; ++i) {
+            if (targetJunctions[i] == current.index && (bestCost == -1 || m_costs[current.index] + targetLengths[i] < bestCost)) {
+                bestCost = m_costs[current.index] + targetLengths[i];
+                bestJunction = current.index;
+            }
+        }
+        // For each of the corridors leaving the current junction
+        for (int i = 0; i < 4; ++i) {
+            const int neighbour = p_maze->getJunctionEdge(current.index, directions[i]);
+            if (neighbour == -1) {
+                continue;
+            }
+            const int cost = m_costs[current.index] + p_maze->getJunctionEdgeLength(current.index, directions[i]);
+            // If the junction has not been reached yet or if this path to it is shorter
+            if (m_visited[neighbour] != m_generation || (m_closed[neighbour] != m_generation && cost < m_costs[neighbour])) {
+                m_visited[neighbour] = m_generation;
+                m_costs[neighbour] = cost;
+                m_parents[neighbour] = current.index;
+                m_directions[neighbour] = directions[i];
+                Node node;
+                node.distance = useHeuristic ? getDistance(p_maze, p_maze->getJunctionCell(neighbour), p_toRow, p_toColumn) : 0;
+                node.cost = cost + node.distance;
+                node.index = neighbour;
+                pushNode(node);
+            }
+        }
+    }
+    m_openList.clear();
+    if (bestCost == -1) {
+        return path;
+    }
+
+    if (bestJunction == -1) {
+        // The target lies on the corridor of the starting Cell
+        appendCorridor(p_maze, path, start, bestDirection, target);
+        return path;
+    }
+    // List the junctions to go through : from the last junction, go from each junction to its parent until reaching the first one
+    QVector<int> junctions;
+    for (int junction = bestJunction; junction != -1; junction = m_parents[junction]) {
+        junctions.prepend(junction);
+    }
+    // Save the path : from the starting Cell to the first junction, then along the corridors linking the junctions
+    if (p_maze->getJunction(start) == -1) {
+        appendCorridor(p_maze, path, start, (Maze::Direction)m_directions[junctions.first()], p_maze->getJunctionCell(junctions.first()));
+    }
+    for (int i = 1; i < junctions.size(); ++i) {
+        appendCorridor(p_maze, path, p_maze->getJunctionCell(junctions[i - 1]), (Maze::Direction)m_directions[junctions[i]],
+                       p_maze->getJunctionCell(junctions[i]));
+    }
+    // And at last from the last junction to the target Cell, which is the way from the target Cell walked backwards
+    if (p_maze->getJunction(target) == -1) {
+        for (int i = 0; i < 4; ++i) {
+            if (!(p_maze->getPassages(target) & directions[i])) {
+                continue;
+            }
+            QList<QPoint> way;
+            appendCorridor(p_maze, way, target, directions[i], p_maze->getJunctionCell(bestJunction));
+            if (!way.isEmpty() && way.size() == bestCost - m_costs[bestJunction]) {
+                way.removeLast();
+                while (!way.isEmpty()) {
+                    path.append(way.takeLast());
+                }
+                path.append(p_maze->getCoords(target));
+                break;
+            }
+        }
+    }
+
+    return path;
+}
+
+void PathFinder::addStart(const Maze *p_maze, const int p_junction, const int p_cost, const Maze::Direction p_direction,
+                          const int p_toRow, const int p_toColumn, const bool p_useHeuristic)
+{
+    if (m_visited[p_junction] == m_generation && m_costs[p_junction] <= p_cost) {
+        return;
+    }
+    m_visited[p_junction] = m_generation;
+    m_costs[p_junction] = p_cost;
+    m_parents[p_junction] = -1;
+    m_directions[p_junction] = p_direction;
+    Node node;
+    node.distance = p_useHeuristic ? getDistance(p_maze, p_maze->getJunctionCell(p_junction), p_toRow, p_toColumn) : 0;
+    node.cost = p_cost + node.distance;
+    node.index = p_junction;
+    pushNode(node);
+}
+
+int PathFinder::getDistance(const Maze *p_maze, const int p_index, const int p_toRow, const int p_toColumn)
+{
+    return abs(p_toRow - p_maze->getRowFromIndex(p_index)) + abs(p_toColumn - p_maze->getColumnFromIndex(p_index));
+}
+
+void PathFinder::appendCorridor(const Maze *p_maze, QList<QPoint> &p_path, const int p_from, const Maze::Direction p_direction, const int p_to)
+{
+    Maze::Direction direction = p_direction;
+    int cell = p_from;
+    const int nbCells = p_maze->getNbRows() * p_maze->getNbColumns();
+    for (int i = 0; i < nbCells && direction != Maze::NONE; ++i) {
+        cell = p_maze->followCorridor(cell, direction);
+        if (cell == -1) {
+            break;
+        }
+        p_path.append(p_maze->getCoords(cell));
+        if (cell == p_to) {
+            return;
+        }
+    }
+    // The corridor does not lead to the expected Cell
+    p_path.clear();
+}
+
+void PathFinder::initSearch(const int p_nbJunctions)
+{
+    if (m_visited.size() != p_nbJunctions) {
+        m_visited.fill(0, p_nbJunctions);
+        m_closed.fill(0, p_nbJunctions);
+        m_costs.resize(p_nbJunctions);
+        m_parents.resize(p_nbJunctions);
+        m_directions.resize(p_nbJunctions);
+        m_generation = 0;
+    }
+    ++m_generation;
+    // When the generation counter wraps, the old stamps could be mistaken for the current search
+    if (m_generation == 0) {
+        m_visited.fill(0);
+        m_closed.fill(0);
+        m_generation = 1;
+    }
+}
+
+void PathFinder::pushNode(const Node &p_node)
+{
+    int i = m_openList.size();
+    m_openList.append(p_node);
+    // Move the node up while its cost is lower than its parent one
+    while (i > 0) {
+        const int parent = (i - 1) / 2;
+        const Node &other = m_openList[parent];
+        if (other.cost < p_node.cost || (other.cost == p_node.cost && other.distance <= p_node.distance)) {
+            break;
+        }
+        m_openList[i] = other;
+        i = parent;
+    }
+    m_openList[i] = p_node;
+}
+
+PathFinder::Node PathFinder::popNode()
+{
+    const Node top = m_openList.first();
+    const Node last = m_openList.last();
+    m_openList.removeLast();
+    const int size = m_openList.size();
+    if (size > 0) {
+        int i = 0;
+        // Move the last node down while one of its children has a lower cost
+        while (true) {
+            int child = 2 * i + 1;
+            if (child >= size) {
+                break;
+            }
+            if (child + 1 < size && (m_openList[child + 1].cost < m_openList[child].cost ||
+                                     (m_openList[child + 1].cost == m_openList[child].cost && m_openList[child + 1].distance < m_openList[child].distance))) {
+                ++child;
+            }
+            const Node &other = m_openList[child];
+            if (last.cost < other.cost || (last.cost == other.cost && last.distance <= other.distance)) {
+                break;
+            }
+            m_openList[i] = other;
+            i = child;
+        }
+        m_openList[i] = last;
+    }
+    return top;
+}
+
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATHFINDER_H
+#define PATHFINDER_H
+
+#include "maze.h"
+
+#include <QList>
+#include <QPoint>
+#include <QVector>
+
+/**
+ * @brief This class computes paths between two Cells of a Maze with the A* algorithm.
+ *
+ * The search runs on the junction graph of the Maze, see Maze::getJunction(), rather than on all its Cells :
+ * only the crossroads and the dead ends are explored, the corridors between them being walked once the path is found.
+ *
+ * The search data is owned by the PathFinder instance and never written into the Maze,
+ * so several instances can search the same Maze at the same time.
+ */
+class PathFinder
+{
+
+private:
+
+    /** A node of the open list */
+    struct Node {
+        /** Estimated cost of the path going through the Cell */
+        int cost;
+        /** Distance from the junction to the target Cell */
+        int distance;
+        /** Junction number in the Maze */
+        int index;
+    };
+
+    /** Identifier of the current search, used to know which scratch values are up to date */
+    quint32 m_generation;
+
+    /** For each junction, the last search that has reached it */
+    QVector<quint32> m_visited;
+
+    /** For each junction, the last search that has closed it */
+    QVector<quint32> m_closed;
+
+    /** For each junction, the cost of the path from the starting Cell */
+    QVector<int> m_costs;
+
+    /** For each junction, the junction which enables to go to it, -1 if it is reached from the starting Cell */
+    QVector<int> m_parents;
+
+    /** For each junction, the Direction of the corridor taken from its parent junction, or from the starting Cell */
+    QVector<quint8> m_directions;
+
+    /** The open list, kept as a binary heap on the Node cost */
+    QVector<Node> m_openList;
+
+public:
+
+    /**
+     * Creates a new PathFinder instance.
+     */
+    PathFinder();
+
+    /**
+     * Deletes the PathFinder instance.
+     */
+    ~PathFinder();
+
+    /**
+     * Gets the shortest path between two Cells of the given Maze.
+     * @param p_maze the Maze to search
+     * @param p_fromRow the row index of the starting Cell
+     * @param p_fromColumn the column index of the starting Cell
+     * @param p_toRow the row index of the target Cell
+     * @param p_toColumn the column index of the target Cell
+     * @return the Cell coordinates to go through, the starting Cell excluded and the target Cell included,
+     * or an empty list if the target Cell cannot be reached
+     */
+    QList<QPoint> findPath(const Maze *p_maze, const int p_fromRow, const int p_fromColumn, const int p_toRow, const int p_toColumn);
+
+private:
+
+    /**
+     * Prepares the scratch data for a new search on a Maze of the given size.
+     * @param p_nbJunctions the number of junctions of the Maze
+     */
+    void initSearch(const int p_nbJunctions);
+
+    /**
+     * Adds a junction reached from the starting Cell to the open list.
+     * @param p_maze the searched Maze
+     * @param p_junction the junction number
+     * @param p_cost the length of the corridor from the starting Cell
+     * @param p_direction the Direction of the corridor from the starting Cell
+     * @param p_toRow the row index of the target Cell
+     * @param p_toColumn the column index of the target Cell
+     * @param p_useHeuristic whether the distance to the target Cell is taken into account
+     */
+    void addStart(const Maze *p_maze, const int p_junction, const int p_cost, const Maze::Direction p_direction,
+                  const int p_toRow, const int p_toColumn, const bool p_useHeuristic);
+
+    /**
+     * Gets the Manhattan distance from a Cell to the target Cell.
+     * @param p_maze the searched Maze
+     * @param p_index the Cell index
+     * @param p_toRow the row index of the target Cell
+     * @param p_toColumn the column index of the target Cell
+     * @return the distance, in Cells
+     */
+    static int getDistance(const Maze *p_maze, const int p_index, const int p_toRow, const int p_toColumn);
+
+    /**
+     * Adds to a path the Cells of a corridor, up to the given Cell.
+     * @param p_maze the searched Maze
+     * @param p_path the path to complete, cleared if the corridor does not lead to the given Cell
+     * @param p_from the index of the Cell the corridor starts from, which is not added
+     * @param p_direction the Direction of the corridor
+     * @param p_to the index of the last Cell to add
+     */
+    static void appendCorridor(const Maze *p_maze, QList<QPoint> &p_path, const int p_from, const Maze::Direction p_direction, const int p_to);
+
+    /**
+     * Adds a node to the open list.
+     * @param p_node the node to add
+     */
+    void pushNode(const Node &p_node);
+
+    /**
+     * Removes the lowest cost node from the open list.
+     * @return the lowest cost node
+     */
+    Node popNode();
+};
+
+#endif
+
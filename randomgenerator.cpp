@@ -0,0 +1,69 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "randomgenerator.h"
+
+namespace
+{
+/** The multiplier of the linear congruential step */
+const quint64 MULTIPLIER = Q_UINT64_C(6364136223846793005);
+/** The increment of the linear congruential step, which must be odd */
+const quint64 INCREMENT = Q_UINT64_C(1442695040888963407);
+}
+
+RandomGenerator::RandomGenerator(const quint64 p_seed)
+{
+    seed(p_seed);
+}
+
+RandomGenerator::~RandomGenerator()
+{
+}
+
+void RandomGenerator::seed(const quint64 p_seed)
+{
+    m_state = 0;
+    next();
+    m_state += p_seed;
+    next();
+}
+
+quint64 RandomGenerator::getState() const
+{
+    return m_state;
+}
+
+void RandomGenerator::setState(const quint64 p_state)
+{
+    m_state = p_state;
+}
+
+quint32 RandomGenerator::next()
+{
+    const quint64 state = m_state;
+    m_state = state * MULTIPLIER + INCREMENT;
+    // Permute the old state : xor the high bits down, then rotate by its top five bits
+    const quint32 value = quint32(((state >> 18) ^ state) >> 27);
+    const quint32 rotation = quint32(state >> 59);
+    return (value >> rotation) | (value << ((32 - rotation) & 31));
+}
+
+int RandomGenerator::bounded(const int p_bound)
+{
+    // Scale the number to the bound rather than taking a remainder, which would favour the low values more
+    return int((quint64(next()) * quint32(p_bound)) >> 32);
+}
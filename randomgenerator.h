@@ -0,0 +1,82 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RANDOMGENERATOR_H
+#define RANDOMGENERATOR_H
+
+#include <QtGlobal>
+
+/**
+ * @brief This class generates pseudo-random numbers with the PCG32 algorithm.
+ *
+ * Each game owns its generator : the numbers only depend on the seed, so a game can be played again exactly,
+ * and several games can run at the same time without sharing any state.
+ */
+class RandomGenerator
+{
+
+private:
+
+    /** The generator state */
+    quint64 m_state;
+
+public:
+
+    /**
+     * Creates a new RandomGenerator instance.
+     * @param p_seed the seed
+     */
+    explicit RandomGenerator(const quint64 p_seed = 0);
+
+    /**
+     * Deletes the RandomGenerator instance.
+     */
+    ~RandomGenerator();
+
+    /**
+     * Starts the generator again from the given seed.
+     * @param p_seed the seed
+     */
+    void seed(const quint64 p_seed);
+
+    /**
+     * @return the generator state, from which the same numbers can be drawn again
+     */
+    quint64 getState() const;
+
+    /**
+     * Sets the generator state.
+     * @param p_state a state given by getState()
+     */
+    void setState(const quint64 p_state);
+
+    /**
+     * Gets the next number.
+     * @return a number uniformly distributed over the 32-bit values
+     */
+    quint32 next();
+
+    /**
+     * Gets the next number below a bound.
+     * @param p_bound the bound, which must be positive
+     * @return a number between 0 and the bound, the bound excluded
+     */
+    int bounded(const int p_bound);
+};
+
+#endif
+
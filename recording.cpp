@@ -0,0 +1,392 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "recording.h"
+
+const int Recording::KEYFRAME_INTERVAL = 400;
+
+namespace
+{
+/** The first bytes of a saved Recording */
+const char MAGIC[] = "KAPR";
+/** The size of the magic */
+const int MAGIC_SIZE = 4;
+/** The version of the saved Recording format */
+const char VERSION = 5;
+/** The number of bits the input kind takes in an encoded input */
+const int INPUT_BITS = 3;
+
+/**
+ * Appends a variable-length integer : 7 bits per byte, the high bit being set on all the bytes but the last one.
+ * @param p_data the bytes to append to
+ * @param p_value the integer
+ */
+void appendVarint(QByteArray &p_data, quint64 p_value)
+{
+    while (p_value >= 0x80) {
+        p_data.append(char((p_value & 0x7f) | 0x80));
+        p_value >>= 7;
+    }
+    p_data.append(char(p_value));
+}
+
+/**
+ * Reads a variable-length integer.
+ * @param p_data the bytes to read from
+ * @param p_position the position to read at, moved after the integer
+ * @param p_value is set to the integer
+ * @return true if a whole integer has been read, false otherwise
+ */
+bool readVarint(const QByteArray &p_data, int &p_position, quint64 &p_value)
+{
+    p_value = 0;
+    for (int shift = 0; shift < 64 && p_position < p_data.size(); shift += 7) {
+        const quint8 byte = quint8(p_data.at(p_position++));
+        p_value |= quint64(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+Recording::Recording() :
+    m_seed(0),
+    m_difficulty(GameState::MEDIUM),
+    m_lastTick(0)
+{
+    rewind();
+}
+
+Recording::Recording(const quint64 p_seed, const GameState::Difficulty p_difficulty, const QByteArray &p_maze) :
+    m_seed(p_seed),
+    m_difficulty(p_difficulty),
+    m_maze(p_maze),
+    m_lastTick(0)
+{
+    rewind();
+}
+
+Recording::~Recording()
+{
+}
+
+quint64 Recording::getSeed() const
+{
+    return m_seed;
+}
+
+GameState::Difficulty Recording::getDifficulty() const
+{
+    return m_difficulty;
+}
+
+const QByteArray &Recording::getMaze() const
+{
+    return m_maze;
+}
+
+void Recording::addInput(const int p_tick, const Input p_input, const int p_value)
+{
+    appendVarint(m_inputs, (quint64(p_tick - m_lastTick) << INPUT_BITS) | p_input);
+    if (p_input == SET_LEVEL) {
+        appendVarint(m_inputs, quint64(p_value));
+    }
+    m_lastTick = p_tick;
+}
+
+void Recording::addKeyframe(const int p_tick, const QByteArray &p_state)
+{
+    Keyframe keyframe;
+    keyframe.tick = p_tick;
+    keyframe.inputPosition = m_inputs.size();
+    keyframe.inputTick = m_lastTick;
+    keyframe.state = p_state;
+    m_keyframes.append(keyframe);
+}
+
+const Recording::Keyframe *Recording::findKeyframe(const int p_tick) const
+{
+    // Search for the first keyframe after the tick, the wanted one being just before
+    int first = 0;
+    int last = m_keyframes.size();
+    while (first < last) {
+        const int middle = (first + last) / 2;
+        if (m_keyframes[middle].tick <= p_tick) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    if (first == 0) {
+        return NULL;
+    }
+    return &m_keyframes[first - 1];
+}
+
+int Recording::getLength() const
+{
+    if (!m_keyframes.isEmpty()) {
+        return qMax(m_lastTick, m_keyframes.last().tick);
+    }
+    return m_lastTick;
+}
+
+void Recording::rewind()
+{
+    m_readPosition = 0;
+    m_nextTick = 0;
+    readNextInput();
+}
+
+void Recording::seek(const Keyframe &p_keyframe)
+{
+    m_readPosition = p_keyframe.inputPosition;
+    m_nextTick = p_keyframe.inputTick;
+    readNextInput();
+}
+
+bool Recording::hasNextInput() const
+{
+    return m_hasNextInput;
+}
+
+int Recording::getNextTick() const
+{
+    return m_nextTick;
+}
+
+Recording::Input Recording::takeNextInput(int &p_value)
+{
+    const Input input = m_nextInput;
+    p_value = m_nextValue;
+    readNextInput();
+    return input;
+}
+
+void Recording::readNextInput()
+{
+    m_hasNextInput = readInput(m_inputs, m_readPosition, m_nextTick, m_nextInput, m_nextValue);
+}
+
+bool Recording::readInput(const QByteArray &p_inputs, int &p_position, int &p_tick, Input &p_input, int &p_value)
+{
+    quint64 code;
+    quint64 value = 0;
+
+    if (!readVarint(p_inputs, p_position, code)) {
+        return false;
+    }
+    p_input = Input(code & ((1 << INPUT_BITS) - 1));
+    if (p_input == SET_LEVEL && !readVarint(p_inputs, p_position, value)) {
+        return false;
+    }
+    p_tick += int(code >> INPUT_BITS);
+    p_value = int(value);
+    return true;
+}
+
+bool Recording::playInputs(GameState *p_gameState, Maze::Direction &p_input)
+{
+    int value;
+
+    while (m_hasNextInput && m_nextTick <= p_gameState->getTick()) {
+        const Input input = takeNextInput(value);
+        switch (input) {
+        case GO_UP:
+        case GO_RIGHT:
+        case GO_DOWN:
+        case GO_LEFT:
+            p_input = getInputDirection(input);
+            break;
+        case PAUSE:
+            // The pauses do not change the game
+            break;
+        case ADD_LIFE:
+            p_gameState->addLife();
+            break;
+        case NEXT_LEVEL:
+            p_gameState->nextLevel();
+            p_gameState->initCharacters();
+            p_input = Maze::NONE;
+            return true;
+        case SET_LEVEL:
+            p_gameState->setLevel(value);
+            p_gameState->initCharacters();
+            p_input = Maze::NONE;
+            return true;
+        }
+    }
+    return false;
+}
+
+Recording::Input Recording::getDirectionInput(const Maze::Direction p_direction)
+{
+    switch (p_direction) {
+    case Maze::UP:
+        return GO_UP;
+    case Maze::RIGHT:
+        return GO_RIGHT;
+    case Maze::DOWN:
+        return GO_DOWN;
+    default:
+        return GO_LEFT;
+    }
+}
+
+Maze::Direction Recording::getInputDirection(const Input p_input)
+{
+    switch (p_input) {
+    case GO_UP:
+        return Maze::UP;
+    case GO_RIGHT:
+        return Maze::RIGHT;
+    case GO_DOWN:
+        return Maze::DOWN;
+    case GO_LEFT:
+        return Maze::LEFT;
+    default:
+        return Maze::NONE;
+    }
+}
+
+QByteArray Recording::save() const
+{
+    const QByteArray maze = qCompress(m_maze, 9);
+    QByteArray data;
+
+    data.reserve(MAGIC_SIZE + 32 + maze.size() + m_inputs.size());
+    data.append(MAGIC, MAGIC_SIZE);
+    data.append(VERSION);
+    appendVarint(data, m_seed);
+    data.append(char(m_difficulty));
+    appendVarint(data, quint64(maze.size()));
+    data.append(maze);
+    appendVarint(data, quint64(m_inputs.size()));
+    data.append(m_inputs);
+
+    // The keyframes index comes before their states, which are compressed together
+    QByteArray states;
+    Keyframe previous = {0, 0, 0, QByteArray()};
+    appendVarint(data, quint64(m_keyframes.size()));
+    for (int i = 0; i < m_keyframes.size(); ++i) {
+        const Keyframe &keyframe = m_keyframes[i];
+        appendVarint(data, quint64(keyframe.tick - previous.tick));
+        appendVarint(data, quint64(keyframe.inputPosition - previous.inputPosition));
+        appendVarint(data, quint64(keyframe.inputTick - previous.inputTick));
+        appendVarint(data, quint64(keyframe.state.size()));
+        states.append(keyframe.state);
+        previous = keyframe;
+    }
+    states = qCompress(states, 9);
+    appendVarint(data, quint64(states.size()));
+    data.append(states);
+    return data;
+}
+
+bool Recording::load(const QByteArray &p_data)
+{
+    int position = MAGIC_SIZE + 1;
+    quint64 seed;
+    quint64 size;
+
+    if (p_data.size() < position || !p_data.startsWith(MAGIC) || p_data.at(MAGIC_SIZE) != VERSION) {
+        return false;
+    }
+    if (!readVarint(p_data, position, seed) || position >= p_data.size()) {
+        return false;
+    }
+    const int difficulty = p_data.at(position++);
+    if (difficulty < GameState::EASY || difficulty > GameState::HARD) {
+        return false;
+    }
+    if (!readVarint(p_data, position, size) || size > quint64(p_data.size() - position)) {
+        return false;
+    }
+    const QByteArray maze = qUncompress(p_data.mid(position, int(size)));
+    position += int(size);
+    if (maze.isEmpty() || !readVarint(p_data, position, size) || size > quint64(p_data.size() - position)) {
+        return false;
+    }
+    const QByteArray inputs = p_data.mid(position, int(size));
+    position += int(size);
+
+    // Read the keyframes index, then their states
+    quint64 nbKeyframes;
+    if (!readVarint(p_data, position, nbKeyframes) || nbKeyframes > quint64(p_data.size() - position)) {
+        return false;
+    }
+    const int count = int(nbKeyframes);
+    QVector<Keyframe> keyframes(count);
+    QVector<int> stateSizes(count);
+    Keyframe previous = {-1, 0, 0, QByteArray()};
+    quint64 tickDelta, positionDelta, inputTickDelta;
+    qint64 statesSize = 0;
+    for (int i = 0; i < keyframes.size(); ++i) {
+        if (!readVarint(p_data, position, tickDelta) || !readVarint(p_data, position, positionDelta)
+            || !readVarint(p_data, position, inputTickDelta) || !readVarint(p_data, position, size)) {
+            return false;
+        }
+        Keyframe &keyframe = keyframes[i];
+        keyframe.tick = qMax(previous.tick, 0) + int(tickDelta);
+        keyframe.inputPosition = previous.inputPosition + int(positionDelta);
+        keyframe.inputTick = previous.inputTick + int(inputTickDelta);
+        if (keyframe.tick <= previous.tick || keyframe.inputPosition > inputs.size() || size > quint64(p_data.size())) {
+            return false;
+        }
+        stateSizes[i] = int(size);
+        statesSize += int(size);
+        previous = keyframe;
+    }
+    if (!readVarint(p_data, position, size) || size != quint64(p_data.size() - position)) {
+        return false;
+    }
+    const QByteArray states = keyframes.isEmpty() ? QByteArray() : qUncompress(p_data.mid(position));
+    if (states.size() != statesSize) {
+        return false;
+    }
+    position = 0;
+    for (int i = 0; i < keyframes.size(); ++i) {
+        keyframes[i].state = states.mid(position, stateSizes[i]);
+        position += stateSizes[i];
+    }
+
+    // Check every input can be decoded, and get the tick of the last one to record after it
+    int inputPosition = 0;
+    int decodedPosition = 0;
+    int tick = 0;
+    int lastTick = 0;
+    Input input;
+    int value;
+    while (readInput(inputs, inputPosition, tick, input, value)) {
+        lastTick = tick;
+        decodedPosition = inputPosition;
+    }
+    if (decodedPosition != inputs.size()) {
+        return false;
+    }
+
+    m_seed = seed;
+    m_difficulty = GameState::Difficulty(difficulty);
+    m_maze = maze;
+    m_inputs = inputs;
+    m_keyframes = keyframes;
+    m_lastTick = lastTick;
+    rewind();
+    return true;
+}
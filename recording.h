@@ -0,0 +1,246 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include "gamestate.h"
+
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * @brief This class records the inputs of a game, so that it can be played again.
+ *
+ * A game only depends on its seed, its Maze, its difficulty and the inputs given at each tick : the Recording keeps these and nothing else.
+ * Each input is stored as a variable-length integer holding the number of ticks since the previous input and the input kind,
+ * so most inputs take a single byte.
+ * The GameState is also saved every KEYFRAME_INTERVAL ticks, so that the game can be played from any tick without running all the ticks before it.
+ */
+class Recording
+{
+
+public:
+
+    /** The inputs a game can receive */
+    enum Input {
+        GO_UP = 0,
+        GO_RIGHT = 1,
+        GO_DOWN = 2,
+        GO_LEFT = 3,
+        PAUSE = 4,          // The game has been paused or resumed
+        ADD_LIFE = 5,
+        NEXT_LEVEL = 6,
+        SET_LEVEL = 7       // The value is the new level
+    };
+
+    /** The number of ticks between two saved states of the game */
+    static const int KEYFRAME_INTERVAL;
+
+    /** A saved state of the game, from which the Recording can be played */
+    struct Keyframe {
+        /** The number of ticks run before the state */
+        int tick;
+        /** The position in the encoded inputs of the first input to play from the state */
+        int inputPosition;
+        /** The tick of the input before that position */
+        int inputTick;
+        /** The saved GameState */
+        QByteArray state;
+    };
+
+private:
+
+    /** The seed of the random-number generator */
+    quint64 m_seed;
+
+    /** The game difficulty */
+    GameState::Difficulty m_difficulty;
+
+    /** The XML description of the Maze */
+    QByteArray m_maze;
+
+    /** The encoded inputs */
+    QByteArray m_inputs;
+
+    /** The tick of the last recorded input */
+    int m_lastTick;
+
+    /** The saved states of the game, by increasing tick */
+    QVector<Keyframe> m_keyframes;
+
+    /** The position of the next input to play in the encoded inputs */
+    int m_readPosition;
+
+    /** True if there is an input left to play */
+    bool m_hasNextInput;
+
+    /** The tick of the next input to play */
+    int m_nextTick;
+
+    /** The next input to play */
+    Input m_nextInput;
+
+    /** The value of the next input to play */
+    int m_nextValue;
+
+public:
+
+    /**
+     * Creates a new empty Recording instance.
+     */
+    Recording();
+
+    /**
+     * Creates a new Recording instance for a game.
+     * @param p_seed the seed of the random-number generator
+     * @param p_difficulty the game difficulty
+     * @param p_maze the XML description of the Maze
+     */
+    Recording(const quint64 p_seed, const GameState::Difficulty p_difficulty, const QByteArray &p_maze);
+
+    /**
+     * Deletes the Recording instance.
+     */
+    ~Recording();
+
+    /**
+     * @return the seed of the random-number generator
+     */
+    quint64 getSeed() const;
+
+    /**
+     * @return the game difficulty
+     */
+    GameState::Difficulty getDifficulty() const;
+
+    /**
+     * @return the XML description of the Maze
+     */
+    const QByteArray &getMaze() const;
+
+    /**
+     * Records an input.
+     * @param p_tick the number of ticks run before the input, which must not be lower than the one of the previous input
+     * @param p_input the input
+     * @param p_value the input value, for the inputs which have one
+     */
+    void addInput(const int p_tick, const Input p_input, const int p_value = 0);
+
+    /**
+     * Records a state of the game, all the inputs given before it having been recorded.
+     * @param p_tick the number of ticks run before the state, which must be greater than the one of the previous state
+     * @param p_state the saved GameState
+     */
+    void addKeyframe(const int p_tick, const QByteArray &p_state);
+
+    /**
+     * Gets the last saved state of the game before a tick.
+     * @param p_tick the tick
+     * @return the saved state with the greatest tick not over the given one, NULL if there is none
+     */
+    const Keyframe *findKeyframe(const int p_tick) const;
+
+    /**
+     * @return the number of ticks the recorded game has lasted, as far as the Recording knows
+     */
+    int getLength() const;
+
+    /**
+     * Goes back to the first input to play.
+     */
+    void rewind();
+
+    /**
+     * Goes to the first input to play from a saved state of the game.
+     * @param p_keyframe the saved state
+     */
+    void seek(const Keyframe &p_keyframe);
+
+    /**
+     * @return true if there is an input left to play
+     */
+    bool hasNextInput() const;
+
+    /**
+     * @return the number of ticks run before the next input to play
+     */
+    int getNextTick() const;
+
+    /**
+     * Takes the next input to play.
+     * @param p_value is set to the input value, for the inputs which have one
+     * @return the input
+     */
+    Input takeNextInput(int &p_value);
+
+    /**
+     * Plays on a GameState the inputs recorded before its current tick.
+     * @param p_gameState the GameState
+     * @param p_input is set to the Direction asked for before the tick, if any
+     * @return true if an input has started a level, the inputs after it being left for the next call, false otherwise
+     */
+    bool playInputs(GameState *p_gameState, Maze::Direction &p_input);
+
+    /**
+     * Gets the recorded input of a Direction the player has asked for.
+     * @param p_direction the Direction, which must not be Maze::NONE
+     * @return the input
+     */
+    static Input getDirectionInput(const Maze::Direction p_direction);
+
+    /**
+     * Gets the Direction of a recorded input.
+     * @param p_input the input
+     * @return the Direction, Maze::NONE if the input is not a Direction
+     */
+    static Maze::Direction getInputDirection(const Input p_input);
+
+    /**
+     * Encodes the Recording.
+     * @return the bytes to save
+     */
+    QByteArray save() const;
+
+    /**
+     * Decodes a Recording, ready to be played.
+     * @param p_data the saved bytes
+     * @return true if the bytes hold a valid Recording, false otherwise
+     */
+    bool load(const QByteArray &p_data);
+
+private:
+
+    /**
+     * Decodes the input at the current read position.
+     */
+    void readNextInput();
+
+    /**
+     * Decodes an input.
+     * @param p_inputs the encoded inputs
+     * @param p_position the position of the input, moved after it
+     * @param p_tick the tick of the previous input, increased up to the tick of the input
+     * @param p_input the decoded input
+     * @param p_value the decoded value of the input
+     * @return true if an input has been decoded, false at the end of the inputs or if they are corrupted
+     */
+    static bool readInput(const QByteArray &p_inputs, int &p_position, int &p_tick, Input &p_input, int &p_value);
+};
+
+#endif
+
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "simulationthread.h"
+
+const int SimulationThread::MAX_LATE_TICKS = 8;
+const int SimulationThread::INPUT_QUEUE_SIZE = 64;
+
+SimulationThread::SimulationThread(Recording *p_recording, const bool p_isReplay) :
+    m_gameState(NULL),
+    m_recording(p_recording),
+    m_isReplay(p_isReplay),
+    m_simulatedTime(0),
+    m_isTurbo(false),
+    m_input(Maze::NONE),
+    m_inputs(INPUT_QUEUE_SIZE),
+    m_hasCheated(false),
+    m_readTick(0),
+    m_isStopping(0),
+    m_isStarted(false)
+{
+}
+
+SimulationThread::~SimulationThread()
+{
+    stop();
+    delete m_gameState;
+}
+
+void SimulationThread::start(const GameState &p_gameState, const QElapsedTimer &p_clock, const qint64 p_simulatedTime, const Maze::Direction p_input, const bool p_isTurbo)
+{
+    if (m_isStarted) {
+        return;
+    }
+    if (m_gameState == NULL) {
+        m_gameState = new GameState(p_gameState);
+    } else {
+        *m_gameState = p_gameState;
+    }
+    m_clock = p_clock;
+    m_simulatedTime = p_simulatedTime;
+    m_input = p_input;
+    m_isTurbo = p_isTurbo;
+    m_hasCheated = false;
+    m_events.clear();
+    m_readTick.store(m_gameState->getTick());
+    m_isStopping.store(0);
+    m_isStarted = true;
+    QThread::start();
+}
+
+void SimulationThread::stop()
+{
+    if (!m_isStarted) {
+        return;
+    }
+    m_isStopping.store(1);
+    wait();
+    m_isStarted = false;
+}
+
+bool SimulationThread::isStarted() const
+{
+    return m_isStarted;
+}
+
+void SimulationThread::addInput(const Recording::Input p_input)
+{
+    m_inputs.push(p_input);
+}
+
+bool SimulationThread::takeInput(Recording::Input &p_input)
+{
+    // Once the thread has stopped, the view thread is the only one to use the queue
+    if (m_isStarted) {
+        return false;
+    }
+    return m_inputs.pop(p_input);
+}
+
+const SimulationThread::Frame *SimulationThread::takeFrame(const int p_lastTick)
+{
+    // Let the thread forget the events of the Frames read, then take the latest one
+    m_readTick.storeRelease(p_lastTick);
+    if (!m_frames.update()) {
+        return NULL;
+    }
+    return &m_frames.getFront();
+}
+
+bool SimulationThread::runTick(GameState *p_gameState, Recording *p_recording, const bool p_isReplay, Maze::Direction p_input)
+{
+    if (p_isReplay) {
+        if (p_recording->playInputs(p_gameState, p_input)) {
+            return true;
+        }
+    } else {
+        // Save the state regularly to play the Recording from any tick
+        if (p_gameState->getTick() % Recording::KEYFRAME_INTERVAL == 0) {
+            p_recording->addKeyframe(p_gameState->getTick(), p_gameState->saveState());
+        }
+        if (p_input != Maze::NONE) {
+            p_recording->addInput(p_gameState->getTick(), Recording::getDirectionInput(p_input));
+        }
+    }
+    p_gameState->step(p_input);
+    return false;
+}
+
+void SimulationThread::run()
+{
+    const qint64 tickDuration = Q_INT64_C(1000000000) / GameState::TICKS_PER_SECOND;
+
+    while (m_isStopping.load() == 0) {
+        if (!m_isTurbo) {
+            const qint64 time = m_clock.nsecsElapsed();
+            // After a long stall, give up the ticks that cannot be caught up, as the Game does
+            if (time - m_simulatedTime > MAX_LATE_TICKS * tickDuration) {
+                m_simulatedTime = time - MAX_LATE_TICKS * tickDuration;
+            }
+            // Sleep until the next tick is due : stop() waits for one tick at most
+            if (m_simulatedTime + tickDuration > time) {
+                usleep((m_simulatedTime + tickDuration - time + 999) / 1000);
+                continue;
+            }
+        }
+        if (playInputs() || runTick(m_gameState, m_recording, m_isReplay, m_input)) {
+            // The Game waits for a key press before the new level
+            publish(true, true);
+            return;
+        }
+        m_input = Maze::NONE;
+        m_simulatedTime += tickDuration;
+        bool isStopped = false;
+        const QVector<GameState::Event> &events = m_gameState->getEvents();
+        for (int i = 0; i < events.size(); ++i) {
+            const TickEvent event = {m_gameState->getTick(), events[i]};
+            m_events.append(event);
+            // The Game pauses after a death or a completed level, until the view has been updated
+            isStopped = isStopped || events[i].type == GameState::KAPMAN_DEATH || events[i].type == GameState::LEVEL_COMPLETED;
+        }
+        publish(isStopped, false);
+        if (isStopped) {
+            return;
+        }
+    }
+}
+
+bool SimulationThread::playInputs()
+{
+    Recording::Input input;
+
+    while (m_inputs.pop(input)) {
+        switch (input) {
+        case Recording::ADD_LIFE:
+            if (!m_isReplay) {
+                m_recording->addInput(m_gameState->getTick(), Recording::ADD_LIFE);
+                m_gameState->addLife();
+                m_hasCheated = true;
+            }
+            break;
+        case Recording::NEXT_LEVEL:
+            if (!m_isReplay) {
+                m_recording->addInput(m_gameState->getTick(), Recording::NEXT_LEVEL);
+                m_gameState->nextLevel();
+                m_hasCheated = true;
+                return true;
+            }
+            break;
+        default:
+            // The last Direction asked for before the tick is the one played, as in the Game
+            if (!m_isReplay && Recording::getInputDirection(input) != Maze::NONE) {
+                m_input = Recording::getInputDirection(input);
+            }
+            break;
+        }
+    }
+    return false;
+}
+
+void SimulationThread::publish(const bool p_stopped, const bool p_levelStarted)
+{
+    Frame &frame = m_frames.getBack();
+    const int readTick = m_readTick.loadAcquire();
+    int nbRead = 0;
+
+    // Forget the events the view thread has read, the others being published again until it reads them
+    while (nbRead < m_events.size() && m_events[nbRead].tick <= readTick) {
+        ++nbRead;
+    }
+    m_events.remove(0, nbRead);
+    frame.state.resize(m_gameState->getSnapshotSize());
+    m_gameState->saveSnapshot(frame.state.data());
+    frame.events = m_events;
+    frame.time = m_simulatedTime;
+    frame.stopped = p_stopped;
+    frame.levelStarted = p_levelStarted;
+    frame.cheated = m_hasCheated;
+    m_frames.publish();
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIMULATIONTHREAD_H
+#define SIMULATIONTHREAD_H
+
+#include "gamestate.h"
+#include "recording.h"
+#include "spscqueue.h"
+#include "triplebuffer.h"
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QVector>
+
+/**
+ * @brief This class runs the ticks of a game on a thread of its own, so that a slow frame of the view does not delay them.
+ *
+ * The thread works on its own copy of the GameState, and is the only one to use the Recording while it runs.
+ * After each tick, it publishes a Frame holding a snapshot of the GameState through a triple buffer, the view thread only reading the latest one.
+ * The player inputs are given to the thread through a lock-free queue, and the ones it has not played when it stops are left to the view thread.
+ * The thread stops by itself after a tick the Game has to wait after : a Kapman death, a completed level or a level started by an input.
+ */
+class SimulationThread : public QThread
+{
+
+public:
+
+    /** An event of the GameState, with the tick it has happened at */
+    struct TickEvent {
+        /** The number of ticks run once the event has happened */
+        int tick;
+        /** The event */
+        GameState::Event event;
+    };
+
+    /** The state of the game after a tick, as published to the view thread */
+    struct Frame {
+        /** The GameState snapshot */
+        QByteArray state;
+        /** The events since the last Frame the view thread has read, in the order they have happened */
+        QVector<TickEvent> events;
+        /** The clock time the tick was due at, in nanoseconds */
+        qint64 time;
+        /** True if the thread has stopped after this Frame */
+        bool stopped;
+        /** True if the thread has stopped because an input has started a level, the tick not having been run */
+        bool levelStarted;
+        /** True if the thread has played a cheat since it has been started */
+        bool cheated;
+    };
+
+private:
+
+    /** The maximum number of ticks run in a row to catch up with the clock */
+    static const int MAX_LATE_TICKS;
+
+    /** The capacity of the queue of the player inputs */
+    static const int INPUT_QUEUE_SIZE;
+
+    /** The copy of the GameState the ticks are run on */
+    GameState *m_gameState;
+
+    /** The Recording of the game inputs, or the one being played */
+    Recording *m_recording;
+
+    /** True if the Recording is played, false if the player inputs are recorded in it */
+    bool m_isReplay;
+
+    /** The clock the ticks are run against, a copy of the one of the view thread */
+    QElapsedTimer m_clock;
+
+    /** The clock time the ticks run so far have reached, in nanoseconds */
+    qint64 m_simulatedTime;
+
+    /** True if the ticks are run without waiting for the clock */
+    bool m_isTurbo;
+
+    /** The Direction the player has asked for since the last tick, Maze::NONE if none */
+    Maze::Direction m_input;
+
+    /** The player inputs, from the view thread */
+    SpscQueue<Recording::Input> m_inputs;
+
+    /** True if a cheat has been played since the thread has been started */
+    bool m_hasCheated;
+
+    /** The published Frames */
+    TripleBuffer<Frame> m_frames;
+
+    /** The events the view thread may not have read yet */
+    QVector<TickEvent> m_events;
+
+    /** The number of ticks run when the view thread has read its last Frame */
+    QAtomicInt m_readTick;
+
+    /** Set by the view thread to stop the thread */
+    QAtomicInt m_isStopping;
+
+    /** True if the thread has been started and not stopped by stop() yet */
+    bool m_isStarted;
+
+public:
+
+    /**
+     * Creates a new SimulationThread instance, which does not run any tick until it is started.
+     * @param p_recording the Recording of the game inputs, or the one to play
+     * @param p_isReplay true if the Recording has to be played, false if the player inputs have to be recorded in it
+     */
+    SimulationThread(Recording *p_recording, const bool p_isReplay);
+
+    /**
+     * Stops the thread and deletes the SimulationThread instance.
+     */
+    ~SimulationThread();
+
+    /**
+     * Runs the ticks from a state of the game, until stop() is called or until the thread stops by itself.
+     * @param p_gameState the state of the game to go on from
+     * @param p_clock the clock to run the ticks against
+     * @param p_simulatedTime the clock time the ticks run so far have reached, in nanoseconds
+     * @param p_input the Direction the player has asked for since the last tick, Maze::NONE if none
+     * @param p_isTurbo true if the ticks have to be run without waiting for the clock
+     */
+    void start(const GameState &p_gameState, const QElapsedTimer &p_clock, const qint64 p_simulatedTime, const Maze::Direction p_input, const bool p_isTurbo);
+
+    /**
+     * Stops the thread, after the tick being run : the Frame of this tick is the last one published.
+     */
+    void stop();
+
+    /**
+     * @return true if the thread has been started and not stopped by stop(), even if it has stopped by itself
+     */
+    bool isStarted() const;
+
+    /**
+     * Gives an input of the player to the thread, which plays it before its next tick.
+     * The input is lost if the thread has not taken the previous ones yet and its queue is full.
+     * @param p_input a Direction the player has asked for, or a cheat
+     */
+    void addInput(const Recording::Input p_input);
+
+    /**
+     * Takes an input the thread has not played before it stopped, from the view thread once stop() has been called.
+     * @param p_input is set to the input taken, if any
+     * @return true if an input has been taken, false if none is left or if the thread has not been stopped
+     */
+    bool takeInput(Recording::Input &p_input);
+
+    /**
+     * Takes the latest published Frame, from the view thread.
+     * @param p_lastTick the number of ticks of the last Frame read, so that the thread forgets the events already read
+     * @return the Frame, which stays valid until the next call, NULL if none has been published since the last call
+     */
+    const Frame *takeFrame(const int p_lastTick);
+
+    /**
+     * Runs a tick of a game, after having played the recorded inputs of the tick, or having recorded the player input.
+     * @param p_gameState the GameState
+     * @param p_recording the Recording of the game
+     * @param p_isReplay true if the Recording is played, false if the player inputs are recorded in it
+     * @param p_input the Direction the player has asked for since the last tick, Maze::NONE if none
+     * @return true if a played input has started a level instead of the tick being run, false otherwise
+     */
+    static bool runTick(GameState *p_gameState, Recording *p_recording, const bool p_isReplay, Maze::Direction p_input);
+
+protected:
+
+    /**
+     * Runs the ticks, publishing a Frame after each of them.
+     */
+    void run() Q_DECL_OVERRIDE;
+
+private:
+
+    /**
+     * Plays the player inputs received since the last tick.
+     * @return true if an input has started a level, false otherwise
+     */
+    bool playInputs();
+
+    /**
+     * Publishes the state of the game.
+     * @param p_stopped true if the thread stops after this Frame
+     * @param p_levelStarted true if the thread stops because an input has started a level
+     */
+    void publish(const bool p_stopped, const bool p_levelStarted);
+};
+
+#endif
+
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <QAtomicInteger>
+
+/**
+ * @brief This class is a lock-free queue of a fixed capacity, between a single producer thread and a single consumer thread.
+ *
+ * The producer only writes the tail and the consumer only writes the head, so that neither of them ever waits for the other :
+ * the producer is told when the queue is full instead.
+ */
+template <typename T>
+class SpscQueue
+{
+
+private:
+
+    /** The slots of the items, whose number is a power of two */
+    T *m_items;
+
+    /** The number of slots minus one, to get the slot of an item from its number */
+    quint32 m_mask;
+
+    /** The number of items pushed since the queue was created, written by the producer */
+    QAtomicInteger<quint32> m_tail;
+
+    /** The number of items popped since the queue was created, written by the consumer */
+    QAtomicInteger<quint32> m_head;
+
+    Q_DISABLE_COPY(SpscQueue)
+
+public:
+
+    /**
+     * Creates a new empty SpscQueue instance.
+     * @param p_capacity the maximum number of items in the queue, rounded up to a power of two
+     */
+    explicit SpscQueue(const int p_capacity);
+
+    /**
+     * Deletes the SpscQueue instance.
+     */
+    ~SpscQueue();
+
+    /**
+     * Adds an item at the end of the queue, from the producer thread.
+     * @param p_item the item
+     * @return true if the item has been added, false if the queue is full
+     */
+    bool push(const T &p_item);
+
+    /**
+     * Removes the item at the beginning of the queue, from the consumer thread.
+     * @param p_item is set to the removed item, if any
+     * @return true if an item has been removed, false if the queue is empty
+     */
+    bool pop(T &p_item);
+
+    /**
+     * Removes all the items, while neither the producer nor the consumer use the queue.
+     */
+    void clear();
+};
+
+template <typename T>
+SpscQueue<T>::SpscQueue(const int p_capacity) : m_tail(0), m_head(0)
+{
+    quint32 capacity = 1;
+
+    while (capacity < quint32(p_capacity)) {
+        capacity *= 2;
+    }
+    m_items = new T[capacity];
+    m_mask = capacity - 1;
+}
+
+template <typename T>
+SpscQueue<T>::~SpscQueue()
+{
+    delete[] m_items;
+}
+
+template <typename T>
+bool SpscQueue<T>::push(const T &p_item)
+{
+    const quint32 tail = m_tail.load();
+
+    // The counters wrap around together, so their difference stays the number of items
+    if (tail - m_head.loadAcquire() > m_mask) {
+        return false;
+    }
+    m_items[tail & m_mask] = p_item;
+    // Publish the item before the new tail
+    m_tail.storeRelease(tail + 1);
+    return true;
+}
+
+template <typename T>
+bool SpscQueue<T>::pop(T &p_item)
+{
+    const quint32 head = m_head.load();
+
+    if (head == m_tail.loadAcquire()) {
+        return false;
+    }
+    p_item = m_items[head & m_mask];
+    // Give the slot back to the producer once the item has been read
+    m_head.storeRelease(head + 1);
+    return true;
+}
+
+template <typename T>
+void SpscQueue<T>::clear()
+{
+    m_head.storeRelease(m_tail.loadAcquire());
+}
+
+#endif
+
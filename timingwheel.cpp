@@ -0,0 +1,246 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "timingwheel.h"
+
+#include <algorithm>
+#include <cstring>
+
+const int TimingWheel::NB_LEVELS = 4;
+const int TimingWheel::SLOT_BITS = 6;
+const int TimingWheel::NB_SLOTS = 1 << TimingWheel::SLOT_BITS;
+const int TimingWheel::MAX_DELAY = (1 << (TimingWheel::SLOT_BITS * TimingWheel::NB_LEVELS)) - 1;
+
+TimingWheel::TimingWheel() :
+    m_tick(0),
+    m_free(-1),
+    m_slots(NB_LEVELS * NB_SLOTS, -1),
+    m_nbTimeouts(0)
+{
+}
+
+TimingWheel::~TimingWheel()
+{
+}
+
+int TimingWheel::getTick() const
+{
+    return m_tick;
+}
+
+bool TimingWheel::isEmpty() const
+{
+    return m_nbTimeouts == 0;
+}
+
+void TimingWheel::add(const int p_timeout, const int p_ticks)
+{
+    int entry = m_free;
+
+    if (entry != -1) {
+        m_free = m_entries[entry].next;
+    } else {
+        entry = m_entries.size();
+        m_entries.append(Entry());
+    }
+    m_entries[entry].expiry = m_tick + qBound(1, p_ticks, MAX_DELAY);
+    m_entries[entry].timeout = p_timeout;
+    insert(entry);
+    ++m_nbTimeouts;
+}
+
+int TimingWheel::remove(const int p_timeout)
+{
+    int nbRemoved = 0;
+
+    // The removed entries stay in their slot until it is reached, so that no slot has to be searched
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries[i].timeout == p_timeout) {
+            m_entries[i].timeout = -1;
+            ++nbRemoved;
+        }
+    }
+    m_nbTimeouts -= nbRemoved;
+    return nbRemoved;
+}
+
+void TimingWheel::clear()
+{
+    m_entries.clear();
+    m_free = -1;
+    m_slots.fill(-1);
+    m_nbTimeouts = 0;
+}
+
+int TimingWheel::getRemainingTicks(const int p_timeout) const
+{
+    int remaining = 0;
+
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries[i].timeout == p_timeout && (remaining == 0 || m_entries[i].expiry - m_tick < remaining)) {
+            remaining = m_entries[i].expiry - m_tick;
+        }
+    }
+    return remaining;
+}
+
+int TimingWheel::getSnapshotSize() const
+{
+    return 2 * sizeof(qint32) + m_nbTimeouts * sizeof(SavedTimeout);
+}
+
+void TimingWheel::saveSnapshot(char *p_data) const
+{
+    const qint32 header[2] = {m_tick, m_nbTimeouts};
+    SavedTimeout timeout;
+
+    memcpy(p_data, header, sizeof(header));
+    p_data += sizeof(header);
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries[i].timeout != -1) {
+            timeout.timeout = m_entries[i].timeout;
+            timeout.remainingTicks = m_entries[i].expiry - m_tick;
+            memcpy(p_data, &timeout, sizeof(timeout));
+            p_data += sizeof(timeout);
+        }
+    }
+}
+
+int TimingWheel::restoreSnapshot(const char *p_data, const int p_size)
+{
+    qint32 header[2];
+    SavedTimeout timeout;
+
+    if (p_size < int(sizeof(header))) {
+        return 0;
+    }
+    memcpy(header, p_data, sizeof(header));
+    if (header[1] < 0 || header[1] > (p_size - int(sizeof(header))) / int(sizeof(SavedTimeout))) {
+        return 0;
+    }
+    const int size = sizeof(header) + header[1] * sizeof(SavedTimeout);
+    p_data += sizeof(header);
+    for (int i = 0; i < header[1]; ++i) {
+        memcpy(&timeout, p_data + i * sizeof(timeout), sizeof(timeout));
+        if (timeout.timeout < 0 || timeout.remainingTicks < 1 || timeout.remainingTicks > MAX_DELAY) {
+            return 0;
+        }
+    }
+    clear();
+    m_tick = header[0];
+    for (int i = 0; i < header[1]; ++i) {
+        memcpy(&timeout, p_data + i * sizeof(timeout), sizeof(timeout));
+        add(timeout.timeout, timeout.remainingTicks);
+    }
+    return size;
+}
+
+const QVector<int> &TimingWheel::advance()
+{
+    m_expired.clear();
+    ++m_tick;
+    // Once a level has made a whole turn, bring the entries of the next slot of the level above it down
+    for (int level = 1; level < NB_LEVELS && (m_tick & ((1 << (SLOT_BITS * level)) - 1)) == 0; ++level) {
+        cascade(level);
+    }
+    // Every entry of the current slot of the first level expires now
+    int &slot = m_slots[m_tick & (NB_SLOTS - 1)];
+    int entry = slot;
+    slot = -1;
+    while (entry != -1) {
+        const int next = m_entries[entry].next;
+        if (m_entries[entry].timeout != -1) {
+            m_expired.append(m_entries[entry].timeout);
+            --m_nbTimeouts;
+        }
+        release(entry);
+        entry = next;
+    }
+    std::sort(m_expired.begin(), m_expired.end());
+    return m_expired;
+}
+
+void TimingWheel::insert(const int p_entry)
+{
+    Entry &entry = m_entries[p_entry];
+    const int delay = entry.expiry - m_tick;
+    int level = 0;
+
+    while (level < NB_LEVELS - 1 && delay >= (1 << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+    int &slot = m_slots[level * NB_SLOTS + ((entry.expiry >> (SLOT_BITS * level)) & (NB_SLOTS - 1))];
+    entry.next = slot;
+    slot = p_entry;
+}
+
+void TimingWheel::release(const int p_entry)
+{
+    m_entries[p_entry].timeout = -1;
+    m_entries[p_entry].next = m_free;
+    m_free = p_entry;
+}
+
+void TimingWheel::cascade(const int p_level)
+{
+    int &slot = m_slots[p_level * NB_SLOTS + ((m_tick >> (SLOT_BITS * p_level)) & (NB_SLOTS - 1))];
+    int entry = slot;
+    slot = -1;
+    while (entry != -1) {
+        const int next = m_entries[entry].next;
+        if (m_entries[entry].timeout != -1) {
+            insert(entry);
+        } else {
+            release(entry);
+        }
+        entry = next;
+    }
+}
+
+QDataStream &operator<<(QDataStream &p_stream, const TimingWheel &p_wheel)
+{
+    p_stream << qint32(p_wheel.m_tick) << qint32(p_wheel.m_nbTimeouts);
+    for (int i = 0; i < p_wheel.m_entries.size(); ++i) {
+        const TimingWheel::Entry &entry = p_wheel.m_entries[i];
+        if (entry.timeout != -1) {
+            p_stream << qint32(entry.timeout) << qint32(entry.expiry - p_wheel.m_tick);
+        }
+    }
+    return p_stream;
+}
+
+QDataStream &operator>>(QDataStream &p_stream, TimingWheel &p_wheel)
+{
+    qint32 tick, nbTimeouts, timeout, remaining;
+
+    p_stream >> tick >> nbTimeouts;
+    if (p_stream.status() != QDataStream::Ok || nbTimeouts < 0) {
+        p_stream.setStatus(QDataStream::ReadCorruptData);
+        return p_stream;
+    }
+    p_wheel.clear();
+    p_wheel.m_tick = tick;
+    for (int i = 0; i < nbTimeouts; ++i) {
+        p_stream >> timeout >> remaining;
+        if (p_stream.status() != QDataStream::Ok || timeout < 0 || remaining < 1 || remaining > TimingWheel::MAX_DELAY) {
+            p_stream.setStatus(QDataStream::ReadCorruptData);
+            return p_stream;
+        }
+        p_wheel.add(timeout, remaining);
+    }
+    return p_stream;
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <QDataStream>
+#include <QVector>
+
+/**
+ * @brief This class schedules the game timeouts in ticks, with a hierarchical timing wheel.
+ *
+ * The timeouts only expire when the wheel is advanced by one tick, so they follow the simulated time :
+ * they stop when the game is paused, and run as fast as the ticks when the game is fast-forwarded.
+ * The wheel has NB_LEVELS levels of NB_SLOTS slots, each slot of a level covering a whole turn of the level below it :
+ * adding, removing and advancing take a constant time whatever the number of timeouts and their delays.
+ * A timeout is only identified by its kind, which the owner of the wheel defines, several timeouts of the same kind being allowed.
+ */
+class TimingWheel
+{
+
+public:
+
+    /** The number of levels of the wheel */
+    static const int NB_LEVELS;
+
+    /** The number of bits of a tick a level covers */
+    static const int SLOT_BITS;
+
+    /** The number of slots of a level */
+    static const int NB_SLOTS;
+
+    /** The longest delay a timeout can have, in ticks */
+    static const int MAX_DELAY;
+
+private:
+
+    /** A scheduled timeout */
+    struct Entry {
+        /** The tick the timeout expires at */
+        int expiry;
+        /** The timeout kind, -1 if the entry is free or the timeout has been removed */
+        int timeout;
+        /** The next entry in the same slot or in the free entries, -1 if none */
+        int next;
+    };
+
+    /** A timeout as copied in a snapshot */
+    struct SavedTimeout {
+        /** The timeout kind */
+        qint32 timeout;
+        /** The number of ticks after which the timeout expires */
+        qint32 remainingTicks;
+    };
+
+    /** The current tick */
+    int m_tick;
+
+    /** The entries, used or free */
+    QVector<Entry> m_entries;
+
+    /** The first free entry, -1 if none */
+    int m_free;
+
+    /** The first entry of each slot, level after level, -1 if the slot is empty */
+    QVector<int> m_slots;
+
+    /** The number of timeouts left to expire */
+    int m_nbTimeouts;
+
+    /** The timeouts which have expired at the current tick */
+    QVector<int> m_expired;
+
+public:
+
+    /**
+     * Creates a new empty TimingWheel instance.
+     */
+    TimingWheel();
+
+    /**
+     * Deletes the TimingWheel instance.
+     */
+    ~TimingWheel();
+
+    /**
+     * @return the number of ticks the wheel has been advanced by
+     */
+    int getTick() const;
+
+    /**
+     * @return true if there is no timeout left to expire
+     */
+    bool isEmpty() const;
+
+    /**
+     * Schedules a timeout.
+     * @param p_timeout the timeout kind, which must not be negative
+     * @param p_ticks the number of ticks after which the timeout expires, from 1 to MAX_DELAY
+     */
+    void add(const int p_timeout, const int p_ticks);
+
+    /**
+     * Removes the timeouts of a kind.
+     * @param p_timeout the timeout kind
+     * @return the number of removed timeouts
+     */
+    int remove(const int p_timeout);
+
+    /**
+     * Removes all the timeouts.
+     */
+    void clear();
+
+    /**
+     * Gets the number of ticks after which the next timeout of a kind expires.
+     * @param p_timeout the timeout kind
+     * @return the number of ticks, 0 if there is no such timeout
+     */
+    int getRemainingTicks(const int p_timeout) const;
+
+    /**
+     * @return the number of bytes of a snapshot of the wheel
+     */
+    int getSnapshotSize() const;
+
+    /**
+     * Copies the current tick and the timeouts, as plain data.
+     * @param p_data the memory to copy to, of getSnapshotSize() bytes
+     */
+    void saveSnapshot(char *p_data) const;
+
+    /**
+     * Restores the current tick and the timeouts from a snapshot.
+     * @param p_data the memory holding the snapshot
+     * @param p_size the number of bytes that can be read
+     * @return the number of bytes of the snapshot, 0 if it is not valid
+     */
+    int restoreSnapshot(const char *p_data, const int p_size);
+
+    /**
+     * Advances the wheel by one tick.
+     * @return the kinds of the timeouts which expire at the new tick, by increasing kind
+     */
+    const QVector<int> &advance();
+
+private:
+
+    /**
+     * Puts an entry in the slot of its expiry tick.
+     * @param p_entry the entry index
+     */
+    void insert(const int p_entry);
+
+    /**
+     * Frees an entry.
+     * @param p_entry the entry index
+     */
+    void release(const int p_entry);
+
+    /**
+     * Moves the entries of the current slot of a level down to the levels below it.
+     * @param p_level the level
+     */
+    void cascade(const int p_level);
+
+    friend QDataStream &operator<<(QDataStream &p_stream, const TimingWheel &p_wheel);
+    friend QDataStream &operator>>(QDataStream &p_stream, TimingWheel &p_wheel);
+};
+
+/**
+ * Saves the current tick and the timeouts of a TimingWheel.
+ * @param p_stream the stream to write to
+ * @param p_wheel the TimingWheel
+ * @return the stream
+ */
+QDataStream &operator<<(QDataStream &p_stream, const TimingWheel &p_wheel);
+
+/**
+ * Restores a TimingWheel saved with the operator above.
+ * @param p_stream the stream to read from, whose status is set to QDataStream::ReadCorruptData if the data is not valid
+ * @param p_wheel the TimingWheel
+ * @return the stream
+ */
+QDataStream &operator>>(QDataStream &p_stream, TimingWheel &p_wheel);
+
+#endif
+
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <QAtomicInt>
+
+/**
+ * @brief This class hands the latest version of a value from a single writer thread to a single reader thread, without any lock.
+ *
+ * The writer fills the back buffer then swaps it with the middle one, while the reader swaps the middle buffer with the front one
+ * to read it : each side always owns a buffer of its own, so that neither of them ever waits for the other.
+ * The reader only gets the latest published value, the values published in between being replaced.
+ */
+template <typename T>
+class TripleBuffer
+{
+
+private:
+
+    /** The bit of m_middle set when the middle buffer has been published and not read yet */
+    static const int FRESH = 4;
+
+    /** The three buffers */
+    T m_buffers[3];
+
+    /** The index of the middle buffer, with the FRESH bit */
+    QAtomicInt m_middle;
+
+    /** The index of the buffer the writer fills */
+    int m_back;
+
+    /** The index of the buffer the reader reads */
+    int m_front;
+
+    Q_DISABLE_COPY(TripleBuffer)
+
+public:
+
+    /**
+     * Creates a new TripleBuffer instance, with nothing published.
+     */
+    TripleBuffer();
+
+    /**
+     * Deletes the TripleBuffer instance.
+     */
+    ~TripleBuffer();
+
+    /**
+     * @return the buffer to fill, from the writer thread
+     */
+    T &getBack();
+
+    /**
+     * Publishes the back buffer, from the writer thread, and gives the writer another buffer to fill.
+     * The new back buffer holds an older value, which has to be filled again.
+     */
+    void publish();
+
+    /**
+     * Takes the latest published buffer, from the reader thread.
+     * @return true if a buffer has been published since the last call, false if the front buffer has not changed
+     */
+    bool update();
+
+    /**
+     * @return the latest buffer taken by update(), from the reader thread
+     */
+    T &getFront();
+};
+
+template <typename T>
+TripleBuffer<T>::TripleBuffer() : m_middle(1), m_back(0), m_front(2)
+{
+}
+
+template <typename T>
+TripleBuffer<T>::~TripleBuffer()
+{
+}
+
+template <typename T>
+T &TripleBuffer<T>::getBack()
+{
+    return m_buffers[m_back];
+}
+
+template <typename T>
+void TripleBuffer<T>::publish()
+{
+    // The writes to the back buffer are released with it
+    m_back = m_middle.fetchAndStoreAcqRel(m_back | FRESH) & ~FRESH;
+}
+
+template <typename T>
+bool TripleBuffer<T>::update()
+{
+    // Only the writer sets the FRESH bit and only the reader clears it
+    if ((m_middle.loadAcquire() & FRESH) == 0) {
+        return false;
+    }
+    m_front = m_middle.fetchAndStoreAcqRel(m_front) & ~FRESH;
+    return true;
+}
+
+template <typename T>
+T &TripleBuffer<T>::getFront()
+{
+    return m_buffers[m_front];
+}
+
+#endif
+